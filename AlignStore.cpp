@@ -0,0 +1,167 @@
+/*
+ * AlignStore.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Contiguous store of a matched test/reference alignment pair in the form the scorer reads it
+ */
+
+#include "AlignStore.h"
+#include "Scorer.h"
+#include "Profile.h"
+#include <algorithm>
+
+using namespace::std;
+
+CRefIndex::CRefIndex(vector <CSequence> &ref, const SAlphabet &alphabet, long long memoryBudget) : _alphabet(alphabet) {
+	CPhaseTimer timer(MapPhase);
+	assert(!ref.empty());
+	_length = ref[0].length();
+	_words = (_length + 63) / 64;
+	// Per row: the row, at most _length residues with an int column and border each, and the mask
+	CheckMemory(memoryBudget, "indexing the reference", (long long)ref.size() * (10LL * _length + 8LL * _words));
+	_mask.assign(ref.size() * _words, 0);
+	_rowOf.reserve(ref.size());
+	string repeated;
+	for(int i = 0; i < (int)ref.size(); i++) {
+		const string &y = ref[i].RawSeq();
+		assert((int)y.size() == _length);
+		if(!_rowOf.emplace(ref[i].Name(), i).second) { repeated += " " + ref[i].Name(); }
+		_names.push_back(ref[i].Name());
+		_rows.push_back(y);
+		_residues.push_back(RemoveGaps(y, _alphabet));
+		_borders.push_back(AnchorBorders(_residues.back()));
+		_residueColumn.push_back(vector <int>());
+		_residueColumn.back().reserve(_residues.back().size());
+		uint64_t *mask = &_mask[(size_t)i * _words];
+		WithAlphabet(_alphabet, [&](auto policy) {
+			for(int c = 0; c < _length; c++) {
+				if(policy.IsGap(y[c])) { continue; }
+				mask[c / 64] |= (uint64_t)1 << (c % 64);
+				_residueColumn.back().push_back(c + 1);
+			}
+		});
+	}
+	if(!repeated.empty()) { throw CError("\nError: names repeated in the reference MSA:" + repeated + "\n"); }
+}
+
+int CRefIndex::Find(const string &name) const {
+	auto row = _rowOf.find(name);
+	return row == _rowOf.end() ? -1 : row->second;
+}
+
+// Knuth-Morris-Pratt: borders[i] is the length of the longest proper prefix of pattern[0..i] that is also a suffix of it
+vector <int> AnchorBorders(const string &pattern) {
+	vector <int> borders;
+	AnchorBorders(pattern, borders);
+	return borders;
+}
+void AnchorBorders(const string &pattern, vector <int> &borders) {
+	borders.assign(pattern.size(), 0);
+	for(int i = 1, k = 0; i < (int)pattern.size(); i++) {
+		while(k > 0 && pattern[i] != pattern[k]) { k = borders[k - 1]; }
+		if(pattern[i] == pattern[k]) { k++; }
+		borders[i] = k;
+	}
+}
+// Every occurrence is counted so an ambiguous anchor can be reported; the scan is a single pass over text, so low complexity
+// repeats cost no more than anything else. An empty pattern sits at the start
+SAnchor FindAnchor(const string &text, const string &pattern, const vector <int> &borders) {
+	SAnchor anchor;
+	int m = pattern.size();
+	if(m == 0) { anchor.offset = 0; anchor.matches = 1; return anchor; }
+	for(int i = 0, k = 0; i < (int)text.size(); i++) {
+		while(k > 0 && text[i] != pattern[k]) { k = borders[k - 1]; }
+		if(text[i] == pattern[k]) { k++; }
+		if(k == m) {
+			if(anchor.matches++ == 0) { anchor.offset = i - m + 1; }
+			k = borders[k - 1];
+		}
+	}
+	return anchor;
+}
+
+CAlignStore::CAlignStore(vector <CSequence> &test, const CRefIndex &ref, const TWarning &warning, long long memoryBudget) : _ref(ref) {
+	CPhaseTimer timer(MapPhase);
+	assert((int)test.size() == ref.Size() && !test.empty());
+	_nSeq = test.size();
+	_testLen = test[0].length();
+	_seqWords = (_nSeq + 63) / 64;
+	// The spans are only known once the rows are mapped; a fragment usually spans about the reference length
+	long long labels = (long long)_nSeq * my_min(_testLen, ref.Length());
+	CheckMemory(memoryBudget, "the alignment store", labels * sizeof(int) + (long long)_testLen * _seqWords * sizeof(uint64_t));
+	_labels.reserve(labels);
+	_span.assign(_nSeq, SRowSpan());
+	_columnMask.assign((size_t)_testLen * _seqWords, 0);
+	_offset.assign(_nSeq, -1);
+	for(int i = 0; i < _nSeq; i++) {
+		SAnchor anchor = SetRow(i, test[i].RawSeq());
+		if(anchor.matches > 1 && warning) {
+			warning("\nWARNING: the reference sequence " + ref.Name(i) + " occurs " + to_string(anchor.matches) + " times in the test sequence; using the first\n");
+		}
+	}
+}
+
+SAnchor CAlignStore::SetRow(int i, const string &row) {
+	static thread_local vector <int> labels;		// Mapped here first, so a row that fails leaves the store as it was
+	SAnchor anchor = MapRow(i, row, labels);
+	SetLabels(i, labels, anchor);
+	return anchor;
+}
+
+SAnchor CAlignStore::MapRow(int i, const string &row, vector <int> &labels) const {
+	assert(i >= 0 && i < _nSeq);
+	if((int)row.size() != _testLen) {
+		throw CError("\nError: new row for " + Name(i) + " has length " + to_string(row.size()) + " instead of " + to_string(_testLen) + "\n");
+	}
+	labels.resize(_testLen);
+	return MapTestLabels(row, _ref, i, labels.data());
+}
+
+void CAlignStore::SetLabels(int i, const vector <int> &labels, const SAnchor &anchor) {
+	assert(i >= 0 && i < _nSeq && (int)labels.size() == _testLen);
+	int first = 0, end = _testLen;
+	while(first < end && labels[first] < 0) { first++; }
+	while(end > first && labels[end - 1] < 0) { end--; }
+	if(first == end) { first = end = 0; }
+	SRowSpan &span = _span[i];
+	int oldFirst = span.first, oldEnd = span.end;
+	if(end - first > span.room) {
+		// The old labels are not needed, so the row is left out of any compaction and appended after it
+		_abandoned += span.room;
+		span = SRowSpan();
+		if(_abandoned > _labels.size() / 2) { Compact(); }
+		span.start = _labels.size();
+		span.room = end - first;
+		_labels.resize(_labels.size() + span.room);
+	}
+	copy(labels.begin() + first, labels.begin() + end, _labels.begin() + span.start);
+	span.first = first;
+	span.end = end;
+	_offset[i] = anchor.offset;
+	// Only columns in the old or new span can have the row's bit set
+	uint64_t bit = (uint64_t)1 << (i % 64);
+	for(int c = oldFirst; c < oldEnd; c++) { _columnMask[(size_t)c * _seqWords + (i / 64)] &= ~bit; }
+	for(int c = first; c < end; c++) {
+		if(labels[c] >= 0) { _columnMask[(size_t)c * _seqWords + (i / 64)] |= bit; }
+	}
+}
+
+// The spans are moved down in the order they sit in the array, so each is copied to where it goes before anything
+// overwrites it
+void CAlignStore::Compact() {
+	vector <int> order(_nSeq);
+	for(int i = 0; i < _nSeq; i++) { order[i] = i; }
+	sort(order.begin(), order.end(), [&](int x, int y) { return _span[x].start < _span[y].start; });
+	size_t next = 0;
+	for(int i : order) {
+		SRowSpan &span = _span[i];
+		int used = span.end - span.first;
+		copy(_labels.begin() + span.start, _labels.begin() + span.start + used, _labels.begin() + next);
+		span.start = next;
+		span.room = used;
+		next += used;
+	}
+	_labels.resize(next);
+	_abandoned = 0;
+}
@@ -0,0 +1,103 @@
+/*
+ * AlignStore.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Contiguous store of a matched test/reference alignment pair in the form the scorer reads it
+ */
+
+#ifndef ALIGNSTORE_H_
+#define ALIGNSTORE_H_
+#include "Sequence.h"
+#include <cstdint>
+#include <unordered_map>
+
+// Where a reference fragment (its residues with the gaps removed) sits in the residues of a test sequence
+struct SAnchor {
+	int offset = -1;		// Residue of the test sequence where the first occurrence starts, or -1 if there is none
+	int matches = 0;		// Number of occurrences, overlapping ones included; more than one means the placement is ambiguous
+};
+std::vector <int> AnchorBorders(const std::string &pattern);		// The Knuth-Morris-Pratt failure function of pattern
+void AnchorBorders(const std::string &pattern, std::vector <int> &borders);	// As above, reusing borders' storage
+SAnchor FindAnchor(const std::string &text, const std::string &pattern, const std::vector <int> &borders);	// Linear in text and pattern
+
+// The reference side of the store. It only depends on the reference MSA, so it is built once and can be shared by any
+// number of test alignments scored against it. For each row it holds the aligned row, its residues with the gaps removed
+// together with the (1-based) column of each residue and their AnchorBorders, and a bit mask with bit c set when column c
+// holds a character. Names are hashed so test rows can be matched to them (CheckMatched); they must be unique. The gaps are
+// those of the alphabet it is built with, which the test rows are mapped with too
+class CRefIndex {
+public:
+	CRefIndex(std::vector <CSequence> &ref, const SAlphabet &alphabet = SAlphabet(), long long memoryBudget = 0);	// Rows in the order given; memoryBudget as in CheckMemory
+	int Size() const { return _names.size(); }
+	int Find(const std::string &name) const;			// Row with the name, or -1
+	int Length() const { return _length; }
+	int Words() const { return _words; }				// Number of 64 bit words in a mask
+	const std::string &Name(int i) const { return _names[i]; }
+	const std::string &Row(int i) const { return _rows[i]; }
+	const std::string &Residues(int i) const { return _residues[i]; }
+	const std::vector <int> &ResidueColumn(int i) const { return _residueColumn[i]; }
+	const std::vector <int> &Borders(int i) const { return _borders[i]; }
+	const uint64_t *Mask(int i) const { return &_mask[(size_t)i * _words]; }
+	const SAlphabet &Alphabet() const { return _alphabet; }
+private:
+	SAlphabet _alphabet;
+	int _length = 0, _words = 0;
+	std::vector <std::string> _names, _rows, _residues;
+	std::unordered_map <std::string, int> _rowOf;		// Row of each name
+	std::vector <std::vector <int> > _residueColumn, _borders;
+	std::vector <uint64_t> _mask;
+};
+
+// The store holds, for each of the N rows (test row i matched to reference row i):
+//  - the span of test columns [First,End) from its first to its last character that is in the reference, and the label of
+//    each column in the span: the reference column (1-based) of the character, or -BIG_NUMBER if it is a gap or outside the
+//    reference fragment (see MapTestLabels). Every column outside the span would be -BIG_NUMBER, so only the span is kept
+//    and the labels take space in proportion to the reference fragments rather than the test length
+//  - the reference row's bit mask, from the CRefIndex
+//  - the offset of the reference fragment in the test sequence's residues, found once per row by FindAnchor
+// and, for each test column, a bit mask over the rows with bit i set when row i has a character that is in the reference.
+// The spans of all rows are packed one after another in one array; a row with no character in the reference has an empty
+// span. A fragment found more than once in its test sequence is placed at the first occurrence, and passed to warning.
+// Rows can be replaced afterwards with SetRow. The reference index must outlive the store
+class CAlignStore {
+public:
+	CAlignStore(std::vector <CSequence> &test, const CRefIndex &ref, const TWarning &warning = TWarning(), long long memoryBudget = 0);	// Rows must already be matched by name
+	int Size() const { return _nSeq; }
+	int TestLength() const { return _testLen; }
+	int RefLength() const { return _ref.Length(); }
+	int RefWords() const { return _ref.Words(); }					// Number of 64 bit words in a reference mask
+	int SeqWords() const { return _seqWords; }						// Number of 64 bit words in a column mask
+	const std::string &Name(int i) const { return _ref.Name(i); }
+	const SAlphabet &Alphabet() const { return _ref.Alphabet(); }
+	int First(int i) const { return _span[i].first; }
+	int End(int i) const { return _span[i].end; }
+	const int *Labels(int i) const { return _labels.data() + _span[i].start; }	// The labels of columns First(i) .. End(i) - 1
+	const uint64_t *RefMask(int i) const { return _ref.Mask(i); }
+	int Offset(int i) const { return _offset[i]; }
+	const uint64_t *ColumnMask(int c) const { return &_columnMask[(size_t)c * _seqWords]; }
+	// Maps row i again from a new test row of the same length, updating its labels, offset and column mask bits; returns its
+	// anchor. Throws CError, leaving the store unchanged, if the row does not fit. A row whose span grows past the room it
+	// had is moved to the end of the label array, and once the room left behind is over half the array it is compacted
+	SAnchor SetRow(int i, const std::string &row);
+	// SetRow in two steps, so several rows can be mapped before any is changed: MapRow only maps the row into the
+	// TestLength() labels, throwing CError if it does not fit, and SetLabels puts them in the store
+	SAnchor MapRow(int i, const std::string &row, std::vector <int> &labels) const;
+	void SetLabels(int i, const std::vector <int> &labels, const SAnchor &anchor);
+private:
+	void Compact();						// Packs the spans' labels together again, each with just the room it needs
+	struct SRowSpan {
+		int first = 0, end = 0;			// Test columns [first,end)
+		size_t start = 0;				// Where its labels start in _labels
+		int room = 0;					// Labels it can hold there
+	};
+	const CRefIndex &_ref;
+	int _nSeq = 0, _testLen = 0;
+	int _seqWords = 0;
+	std::vector <SRowSpan> _span;
+	std::vector <int> _labels, _offset;
+	size_t _abandoned = 0;				// Labels in _labels no span uses any more
+	std::vector <uint64_t> _columnMask;
+};
+
+#endif /* ALIGNSTORE_H_ */
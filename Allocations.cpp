@@ -0,0 +1,26 @@
+/*
+ * Allocations.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Replacement global allocation functions that count the calls to operator new (threadAllocations, Profile.h)
+ *	---
+ *	Linked into the programs rather than the library, so an application embedding libmsascorer.a keeps its own allocator.
+ *	The array and nothrow forms call these.
+ */
+
+#include "Profile.h"
+#include <cstdlib>
+#include <new>
+
+using namespace::std;
+
+void *operator new(size_t size) {
+	threadAllocations++;
+	if(profiling) { counters[AllocCount]++; }
+	void *p = malloc(size == 0 ? 1 : size);
+	if(p == nullptr) { throw bad_alloc(); }
+	return p;
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
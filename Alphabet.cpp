@@ -0,0 +1,70 @@
+/*
+ * Alphabet.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Character classification by alphabet
+ */
+
+#include "Alphabet.h"
+#include "Sequence.h"
+
+using namespace::std;
+
+constexpr SCharTable SProtein::table;
+constexpr SCharTable SDNA::table;
+constexpr SCharTable SRNA::table;
+
+SAlphabet MakeAlphabet(EAlphabet residues, const string &gaps) {
+	const SCharTable *tables[] = { &SProtein::table, &SDNA::table, &SRNA::table };
+	assert(residues != CustomGaps);
+	SAlphabet retAlphabet;
+	retAlphabet.residues = residues;
+	retAlphabet.table = *tables[residues];
+	if(gaps.empty()) { return retAlphabet; }
+	for(auto &c : retAlphabet.table.cls) { if(c == GapChar) { c = OtherChar; } }
+	for(char g : gaps) { retAlphabet.table.cls[(unsigned char)g] = GapChar; }
+	retAlphabet.customGaps = true;
+	return retAlphabet;
+}
+
+bool SameGaps(const SAlphabet &a, const SAlphabet &b) {
+	for(int c = 0; c < 256; c++) {
+		if(a.IsGap(c) != b.IsGap(c)) { return false; }
+	}
+	return true;
+}
+
+// The other ambiguity codes are also amino acids, so only A, C, G, T, U and N count as nucleotides and the rest are left to
+// the margin below nucleotideFraction
+EAlphabet DetectAlphabet(vector <CSequence> &data, const SAlphabet &alphabet) {
+	const double nucleotideFraction = 0.9;
+	long long residues = 0, nucleotides = 0, t = 0, u = 0;
+	for(auto &s : data) {
+		for(char c : s.RawSeq()) {
+			if(alphabet.IsGap(c)) { continue; }
+			residues++;
+			switch(c) {
+			case 'A': case 'C': case 'G': case 'N': case 'a': case 'c': case 'g': case 'n': nucleotides++; break;
+			case 'T': case 't': nucleotides++; t++; break;
+			case 'U': case 'u': nucleotides++; u++; break;
+			}
+		}
+	}
+	if(residues == 0 || nucleotides < nucleotideFraction * residues) { return Protein; }
+	return u > t ? RNA : DNA;
+}
+
+string AlphabetName(EAlphabet alphabet) {
+	switch(alphabet) {
+	case Protein: return "protein";
+	case DNA: return "dna";
+	case RNA: return "rna";
+	case CustomGaps: return "custom";
+	}
+	return "";
+}
+
+string AlphabetName(const SAlphabet &alphabet) {
+	return AlphabetName(alphabet.customGaps ? CustomGaps : alphabet.residues);
+}
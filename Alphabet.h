@@ -0,0 +1,97 @@
+/*
+ * Alphabet.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Character classification by alphabet
+ *	---
+ *	Each alphabet is a policy class whose 256-entry table is built at compile time, saying whether each character is a
+ *	residue, a gap or neither. The alphabet is passed with each reference and read as an SAlphabet value, so callers on
+ *	different threads can use different ones, and the per-character loops are instantiated for each policy through
+ *	WithAlphabet, so the test in the loop is a lookup in a constant table.
+ *	All the alphabets use the original gap set, so the choice of alphabet never changes a score; only a custom gap set
+ *	(-gaps) does. Protein keeps the original residues, the 20 upper case amino acids; the nucleotide alphabets accept the
+ *	IUPAC codes in either case.
+ */
+
+#ifndef ALPHABET_H_
+#define ALPHABET_H_
+#include <string>
+#include <vector>
+
+class CSequence;
+
+enum EAlphabet { Protein, DNA, RNA, CustomGaps };
+enum ECharClass { OtherChar = 0, GapChar, ResidueChar };
+
+struct SCharTable {
+	unsigned char cls[256];
+	constexpr bool Gap(char c) const { return cls[(unsigned char)c] == GapChar; }
+	constexpr bool Residue(char c) const { return cls[(unsigned char)c] == ResidueChar; }
+};
+
+// Residues are added in upper case, and in lower case too if lowerCase; the gaps are added last and take precedence
+constexpr SCharTable MakeCharTable(const char *residues, const char *gaps, bool lowerCase) {
+	SCharTable table {};
+	for(const char *r = residues; *r; r++) {
+		table.cls[(unsigned char)*r] = ResidueChar;
+		if(lowerCase && *r >= 'A' && *r <= 'Z') { table.cls[(unsigned char)(*r - 'A' + 'a')] = ResidueChar; }
+	}
+	for(const char *g = gaps; *g; g++) { table.cls[(unsigned char)*g] = GapChar; }
+	return table;
+}
+
+#define LEGACY_GAPS ".*-X?"
+#define AMINO_ACIDS "ARNDCQEGHILKMFPSTWYV"
+
+struct SProtein {
+	static constexpr SCharTable table = MakeCharTable(AMINO_ACIDS, LEGACY_GAPS, false);
+	static bool IsGap(char c) { return table.Gap(c); }
+	static bool IsResidue(char c) { return table.Residue(c); }
+};
+struct SDNA {
+	static constexpr SCharTable table = MakeCharTable("ACGTRYKMSWBDHVN", LEGACY_GAPS, true);
+	static bool IsGap(char c) { return table.Gap(c); }
+	static bool IsResidue(char c) { return table.Residue(c); }
+};
+struct SRNA {
+	static constexpr SCharTable table = MakeCharTable("ACGURYKMSWBDHVN", LEGACY_GAPS, true);
+	static bool IsGap(char c) { return table.Gap(c); }
+	static bool IsResidue(char c) { return table.Residue(c); }
+};
+// The residues of an alphabet with a gap set of its own, looked up in the table of the SAlphabet it comes from
+struct SCustomGaps {
+	const SCharTable *table;
+	bool IsGap(char c) const { return table->Gap(c); }
+	bool IsResidue(char c) const { return table->Residue(c); }
+};
+// Anything that is a residue in some alphabet, in either case. Used to recognise file formats before the alphabet is known
+constexpr SCharTable anyResidue = MakeCharTable(AMINO_ACIDS "BJOUZ", LEGACY_GAPS, true);
+
+// The characters an alignment is read and scored with. The default is protein with the original gaps
+struct SAlphabet {
+	EAlphabet residues = Protein;		// Protein, DNA or RNA
+	bool customGaps = false;			// Whether table has a gap set other than LEGACY_GAPS
+	SCharTable table = SProtein::table;
+	bool IsGap(char c) const { return table.Gap(c); }
+	bool IsResidue(char c) const { return table.Residue(c); }
+};
+
+SAlphabet MakeAlphabet(EAlphabet residues, const std::string &gaps = "");	// A non-empty gaps replaces the gap set
+bool SameGaps(const SAlphabet &a, const SAlphabet &b);
+EAlphabet DetectAlphabet(std::vector <CSequence> &data, const SAlphabet &alphabet);	// DNA or RNA if nearly all residues are nucleotides, otherwise Protein
+std::string AlphabetName(EAlphabet alphabet);
+std::string AlphabetName(const SAlphabet &alphabet);		// As above, or "custom" with a custom gap set
+
+// Calls f with an instance of the policy for alphabet, so f can be a generic lambda taking (auto policy) and using
+// policy.IsGap in its loops
+template <class TFunc> auto WithAlphabet(const SAlphabet &alphabet, TFunc f) -> decltype(f(SProtein())) {
+	if(alphabet.customGaps) { return f(SCustomGaps{ &alphabet.table }); }
+	switch(alphabet.residues) {
+	case DNA: return f(SDNA());
+	case RNA: return f(SRNA());
+	default: return f(SProtein());
+	}
+}
+
+#endif /* ALPHABET_H_ */
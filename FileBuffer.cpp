@@ -0,0 +1,69 @@
+/*
+ * FileBuffer.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Read-only view of a whole input file, memory mapped where possible
+ */
+
+#include "FileBuffer.h"
+#include "Sequence.h"
+#include "Gzip.h"
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace::std;
+
+CFileBuffer::CFileBuffer(const string &file) {
+	bool console = file == "-";
+	if(!console && IsGzipFile(file)) {
+		CInputFile input(file);
+		_contents.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+		_data = _contents.data();
+		_size = _contents.size();
+		return;
+	}
+	int fd = console ? STDIN_FILENO : open(file.c_str(), O_RDONLY);
+	struct stat info;
+	if(fd < 0 || fstat(fd, &info) != 0) {
+		if(fd >= 0 && !console) { close(fd); }
+		throw CError("Error opening '" + file + "'. Provide a valid file.\n");
+	}
+	if(S_ISREG(info.st_mode) && info.st_size > 0) {
+		void *map = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(map != MAP_FAILED) {
+			madvise(map, info.st_size, MADV_SEQUENTIAL);
+			_map = map;
+			_data = (const char *)map;
+			_size = info.st_size;
+		}
+	}
+	if(_map == nullptr) {
+		char block[1 << 16];
+		ssize_t got;
+		while((got = read(fd, block, sizeof(block))) > 0) { _contents.append(block, got); }
+		if(got < 0) {
+			if(!console) { close(fd); }
+			throw CError("Error reading '" + file + "'.\n");
+		}
+		_data = _contents.data();
+		_size = _contents.size();
+	}
+	if(!console) { close(fd); }
+	// Whether stdin is compressed can only be seen once it has been read
+	if(console && IsGzipData(_data, _size)) {
+		string contents = Gunzip(_data, _size, "stdin");
+		if(_map != nullptr) { munmap(_map, _size); _map = nullptr; }
+		_contents.swap(contents);
+		_data = _contents.data();
+		_size = _contents.size();
+	}
+}
+
+CFileBuffer::~CFileBuffer() {
+	if(_map != nullptr) { munmap(_map, _size); }
+}
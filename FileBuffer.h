@@ -0,0 +1,43 @@
+/*
+ * FileBuffer.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Read-only view of a whole input file, memory mapped where possible
+ */
+
+#ifndef FILEBUFFER_H_
+#define FILEBUFFER_H_
+#include <istream>
+#include <string>
+
+// Maps the file read-only; files that cannot be mapped (pipes, empty files) are read into memory instead, as are gzip
+// compressed files, decompressed. The file "-" is stdin, which is decompressed too if it turns out to be gzip.
+// The contents stay valid for the lifetime of the object
+class CFileBuffer {
+public:
+	CFileBuffer(const std::string &file);
+	~CFileBuffer();
+	const char *Data() const { return _data; }
+	size_t Size() const { return _size; }
+	bool Mapped() const { return _map != nullptr; }
+private:
+	CFileBuffer(const CFileBuffer &) = delete;
+	CFileBuffer &operator=(const CFileBuffer &) = delete;
+	const char *_data = nullptr;
+	size_t _size = 0;
+	void *_map = nullptr;		// The mapping, if the file was mapped
+	std::string _contents;		// The contents, if it was read instead
+};
+
+// An istream reading characters in memory, such as a CFileBuffer's contents, without copying them
+class CBufferStream : public std::istream {
+public:
+	CBufferStream(const char *data, size_t size) : std::istream(&_buf) { _buf.Set(data, size); }
+private:
+	struct SBuf : public std::streambuf {
+		void Set(const char *data, size_t size) { char *p = const_cast<char *>(data); setg(p, p, p + size); }
+	} _buf;
+};
+
+#endif /* FILEBUFFER_H_ */
@@ -0,0 +1,127 @@
+/*
+ * Gzip.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Reading gzip compressed inputs as a stream, with the decompression on its own thread
+ */
+
+#include "Gzip.h"
+#include "Sequence.h"
+#include <fstream>
+#include <zlib.h>
+
+using namespace::std;
+
+const int gzipBlockBytes = 1 << 20;		// Size of the decompressed blocks handed to the reader
+const size_t gzipBlocksAhead = 4;		// How many the decompression thread may get ahead
+
+bool IsGzipFile(const string &file) {
+	ifstream input(file.c_str(), ifstream::binary);
+	char magic[2] = { 0, 0 };
+	input.read(magic, 2);
+	return IsGzipData(magic, input.gcount());
+}
+bool IsGzipData(const char *data, size_t size) {
+	return size >= 2 && (unsigned char)data[0] == 0x1f && (unsigned char)data[1] == 0x8b;
+}
+
+// Concatenated gzip members are read one after another, as gzread does
+string Gunzip(const char *data, size_t size, const string &file) {
+	string retData;
+	z_stream z = {};
+	if(inflateInit2(&z, 16 + MAX_WBITS) != Z_OK) { throw CError("Error decompressing " + file + "\n"); }
+	z.next_in = (Bytef *)data;
+	z.avail_in = size;
+	int status = Z_OK;
+	while(status == Z_OK || (status == Z_STREAM_END && z.avail_in > 0)) {
+		if(status == Z_STREAM_END) { inflateReset(&z); }
+		size_t done = retData.size();
+		retData.resize(done + gzipBlockBytes);
+		z.next_out = (Bytef *)&retData[done];
+		z.avail_out = gzipBlockBytes;
+		status = inflate(&z, Z_NO_FLUSH);
+		retData.resize(done + gzipBlockBytes - z.avail_out);
+		if(status == Z_BUF_ERROR && z.avail_in > 0) { status = Z_OK; }		// Only out of output space
+	}
+	string message = z.msg != NULL ? z.msg : "unexpected end of file";
+	inflateEnd(&z);
+	if(status != Z_STREAM_END) { throw CError("Error decompressing " + file + ": " + message + "\n"); }
+	return retData;
+}
+
+CGzipStreamBuf::CGzipStreamBuf(const string &file) {
+	gzFile gz = gzopen(file.c_str(), "rb");
+	if(gz == NULL) { throw CError("Error opening '" + file + "'. Provide a valid file.\n"); }
+	gzbuffer(gz, 1 << 17);
+	_gz = gz;
+	_thread = thread(&CGzipStreamBuf::Inflate, this);
+}
+
+CGzipStreamBuf::~CGzipStreamBuf() {
+	{	lock_guard<mutex> guard(_lock);
+		_stop = true;
+	}
+	_space.notify_all();
+	_thread.join();
+	gzclose((gzFile)_gz);
+}
+
+void CGzipStreamBuf::Inflate() {
+	gzFile gz = (gzFile)_gz;
+	for(;;) {
+		string block(gzipBlockBytes, '\0');
+		int got = gzread(gz, &block[0], gzipBlockBytes);
+		int status = Z_OK;
+		const char *message = got <= 0 ? gzerror(gz, &status) : NULL;
+		unique_lock<mutex> lock(_lock);
+		if(got <= 0) {
+			if(status != Z_OK) { _error = message; }		// A truncated file ends with Z_BUF_ERROR rather than a plain end
+			_done = true;
+			_ready.notify_all();
+			return;
+		}
+		block.resize(got);
+		_space.wait(lock, [&]() { return _stop || _blocks.size() < gzipBlocksAhead; });
+		if(_stop) { return; }
+		_blocks.push_back(move(block));
+		_ready.notify_all();
+	}
+}
+
+CGzipStreamBuf::int_type CGzipStreamBuf::underflow() {
+	if(gptr() < egptr()) { return traits_type::to_int_type(*gptr()); }
+	unique_lock<mutex> lock(_lock);
+	_ready.wait(lock, [&]() { return !_blocks.empty() || _done; });
+	if(_blocks.empty()) {
+		if(!_error.empty()) { throw CError("Error decompressing " + _error + "\n"); }		// zlib's message starts with the file name
+		return traits_type::eof();
+	}
+	_current = move(_blocks.front());
+	_blocks.pop_front();
+	_space.notify_all();
+	setg(&_current[0], &_current[0], &_current[0] + _current.size());
+	return traits_type::to_int_type(_current[0]);
+}
+
+SCharSpan CGzipStreamBuf::Peek() {
+	SCharSpan span;
+	if(traits_type::eq_int_type(sgetc(), traits_type::eof())) { return span; }
+	span.data = gptr();
+	span.size = egptr() - gptr();
+	return span;
+}
+
+// Exceptions from the buffer are passed on to the reader (badbit), so a corrupt file is not mistaken for a short one
+CInputFile::CInputFile(const string &file) : istream(nullptr) {
+	bool opened = true;
+	if(IsGzipFile(file)) { _buf.reset(new CGzipStreamBuf(file)); }
+	else {
+		filebuf *buf = new filebuf();
+		_buf.reset(buf);
+		opened = buf->open(file.c_str(), ios::in) != NULL;
+	}
+	rdbuf(_buf.get());
+	if(!opened) { setstate(failbit); }
+	exceptions(badbit);
+}
@@ -0,0 +1,61 @@
+/*
+ * Gzip.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Reading gzip compressed inputs as a stream, with the decompression on its own thread
+ *	---
+ *	A file is taken as gzip compressed when it starts with the gzip magic bytes, whatever its name. The decompression thread
+ *	keeps a few blocks ahead of the reader, so parsing one block overlaps with inflating the next, and nothing is written
+ *	to disk.
+ */
+
+#ifndef GZIP_H_
+#define GZIP_H_
+#include "Sequence.h"
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+bool IsGzipFile(const std::string &file);		// Whether the file starts with the gzip magic bytes
+bool IsGzipData(const char *data, size_t size);	// Whether data starts with them
+// Decompresses the whole of a gzip stream in memory, for inputs such as stdin that can only be read once. A corrupt or
+// truncated stream is thrown as CError naming file
+std::string Gunzip(const char *data, size_t size, const std::string &file);
+
+// The decompressed contents of a gzip file. A read or corruption error is thrown as CError from the read that reaches it
+class CGzipStreamBuf : public std::streambuf {
+public:
+	CGzipStreamBuf(const std::string &file);
+	~CGzipStreamBuf();
+	SCharSpan Peek();		// The next inflated block without reading it, or nothing at the end of the file
+protected:
+	int_type underflow() override;
+private:
+	CGzipStreamBuf(const CGzipStreamBuf &) = delete;
+	CGzipStreamBuf &operator=(const CGzipStreamBuf &) = delete;
+	void Inflate();									// Body of the decompression thread
+	void *_gz = nullptr;							// The zlib gzFile
+	std::mutex _lock;
+	std::condition_variable _ready, _space;			// A block is waiting; there is room for another
+	std::deque <std::string> _blocks;				// Decompressed blocks not yet read
+	bool _done = false, _stop = false;
+	std::string _error;								// Why the decompression stopped early
+	std::string _current;							// The block being read
+	std::thread _thread;
+};
+
+// An input stream over a file, decompressing it if it is gzip compressed. Fails to open (good() is false) like an
+// ifstream; errors while decompressing are thrown as CError
+class CInputFile : public std::istream {
+public:
+	CInputFile(const std::string &file);
+private:
+	std::unique_ptr <std::streambuf> _buf;
+};
+
+#endif /* GZIP_H_ */
@@ -0,0 +1,101 @@
+/*
+ * Incremental.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Rescoring a test MSA that changes a few rows or columns at a time, for iterative aligners
+ */
+
+#include "Incremental.h"
+#include <algorithm>
+
+using namespace::std;
+
+// CheckMatched is called from the initialiser list, as the store can only be built from matched rows
+static vector <CSequence> &Matched(vector <CSequence> &test, const CRefIndex &ref) {
+	CheckMatched(test, ref);
+	return test;
+}
+
+CIncrementalScorer::CIncrementalScorer(vector <CSequence> &test, const CRefIndex &ref, int threads, const TWarning &warning) : _store(Matched(test, ref), ref, warning) {
+	for(auto &s : test) { _rows.push_back(s.RawSeq()); }
+	_score = ScorePairs(_store, threads);
+}
+
+void CIncrementalScorer::ReplaceRow(int k, const string &row) {
+	if(k < 0 || k >= Size()) { throw CError("\nError: no row " + to_string(k) + " to replace\n"); }
+	SScore before = RowScore(k);
+	_store.SetRow(k, row);
+	_rows[k] = row;
+	_score -= before;
+	_score += RowScore(k);
+	SetDerived();
+	Verify();
+}
+
+void CIncrementalScorer::UpdateColumns(int a, int b, const vector <string> &block) {
+	int width = b - a + 1;
+	if(a < 0 || b >= Length() || width < 1) { throw CError("\nError: columns " + to_string(a) + ".." + to_string(b) + " are not in the alignment\n"); }
+	if(block.size() != _rows.size()) { throw CError("\nError: the new columns have " + to_string(block.size()) + " rows instead of " + to_string(Size()) + "\n"); }
+	for(auto &r : block) {
+		if((int)r.size() != width) { throw CError("\nError: the new columns are " + to_string(r.size()) + " wide instead of " + to_string(width) + "\n"); }
+	}
+	// Every changed row is mapped before any is changed, so if one does not fit the scorer is left as it was
+	vector <int> changed;
+	vector <bool> moved;
+	vector <SAnchor> anchors;
+	for(int k = 0; k < Size(); k++) {
+		if(_rows[k].compare(a, width, block[k]) == 0) { continue; }
+		changed.push_back(k);
+		moved.push_back(RemoveGaps(_rows[k].substr(a, width), _store.Alphabet()) == RemoveGaps(block[k], _store.Alphabet()));
+	}
+	if(_mapped.size() < changed.size()) { _mapped.resize(changed.size()); }
+	for(size_t n = 0; n < changed.size(); n++) {
+		string row = _rows[changed[n]];
+		row.replace(a, width, block[changed[n]]);
+		anchors.push_back(_store.MapRow(changed[n], row, _mapped[n]));
+	}
+	// Rows whose residues change in the block are mapped differently outside it too, so their pairs are rescored whole
+	for(size_t n = 0; n < changed.size(); n++) {
+		if(moved[n]) { continue; }
+		int k = changed[n];
+		SScore before = RowScore(k);
+		_store.SetLabels(k, _mapped[n], anchors[n]);
+		_rows[k].replace(a, width, block[k]);
+		_score -= before;
+		_score += RowScore(k);
+	}
+	// The rest only move gaps, which keeps their anchors, so only the block's labels change
+	if(find(moved.begin(), moved.end(), true) != moved.end()) {
+		SScore before = ScoreTestColumns(_store, a, b + 1);
+		for(size_t n = 0; n < changed.size(); n++) {
+			if(!moved[n]) { continue; }
+			_store.SetLabels(changed[n], _mapped[n], anchors[n]);
+			_rows[changed[n]].replace(a, width, block[changed[n]]);
+		}
+		_score -= before;
+		_score += ScoreTestColumns(_store, a, b + 1);
+	}
+	SetDerived();
+	Verify();
+}
+
+SScore CIncrementalScorer::RowScore(int k) const {
+	SScore retScore;
+	for(int j = 0; j < Size(); j++) {
+		if(j != k) { retScore += ComparePairs(_store, k, j); }
+	}
+	return retScore;
+}
+
+void CIncrementalScorer::SetDerived() {
+	_score.FN = _score.totalRef - _score.TP;
+	_score.FP = _score.totalTest - _score.TP;
+	assert(_score.FN >= 0 && _score.FP >= 0);
+}
+
+void CIncrementalScorer::Verify() const {
+#ifdef MSA_DEBUG
+	if(!(ScorePairs(_store) == _score)) { throw CError("\nError: the incremental score differs from a full rescoring\n"); }
+#endif
+}
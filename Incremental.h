@@ -0,0 +1,43 @@
+/*
+ * Incremental.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Rescoring a test MSA that changes a few rows or columns at a time, for iterative aligners
+ *	---
+ *	The scorer keeps the current test rows, their alignment store and the running score. Replacing row k recomputes only
+ *	the N-1 pairs involving k: O(N L). Changing columns a..b without changing any row's residues (moving gaps) leaves
+ *	every label outside the block alone, so the score changes by the column tallies of the block: O(N (b-a)). Rows whose
+ *	residues do change in the block are replaced whole. The reference never changes, so neither does totalRef.
+ *	Built with MSA_DEBUG (make DEBUG=1) every update is checked against a full rescoring.
+ */
+
+#ifndef INCREMENTAL_H_
+#define INCREMENTAL_H_
+#include "Scorer.h"
+
+// The test rows are put in reference order (CheckMatched), so row k is the reference's row k. The reference index must
+// outlive the scorer.
+// Updates that do not fit (wrong length, reference no longer found) throw CError, and the score stays that of the
+// current rows
+class CIncrementalScorer {
+public:
+	CIncrementalScorer(std::vector <CSequence> &test, const CRefIndex &ref, int threads = 1, const TWarning &warning = TWarning());
+	const SScore &Score() const { return _score; }
+	int Size() const { return _rows.size(); }
+	int Length() const { return _store.TestLength(); }
+	const std::string &Name(int k) const { return _store.Name(k); }
+	const std::string &Row(int k) const { return _rows[k]; }
+	void ReplaceRow(int k, const std::string &row);							// Row k becomes row, which must be Length() long
+	void UpdateColumns(int a, int b, const std::vector <std::string> &block);	// Columns a..b (inclusive) of row k become block[k]
+private:
+	SScore RowScore(int k) const;		// Total of the pairs of row k with every other row
+	void SetDerived();					// FN and FP from the other totals
+	void Verify() const;				// Compares with a full rescoring when built with MSA_DEBUG
+	CAlignStore _store;
+	std::vector <std::string> _rows;
+	std::vector <std::vector <int> > _mapped;	// Scratch for the labels of the rows UpdateColumns changes
+	SScore _score;
+};
+
+#endif /* INCREMENTAL_H_ */
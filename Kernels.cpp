@@ -0,0 +1,121 @@
+/*
+ * Kernels.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Vectorised counting kernels for comparing a pair of sequences
+ *	---
+ *	Labels are >= 0 for characters in the reference and negative otherwise, so both labels of a column are present exactly when
+ *	the sign bit of (x | y) is clear. True positives are the present columns where x == y. Every kernel counts these with
+ *	compares and masks rather than building the list of pairs that MakePairs/CountTP use.
+ *	Reference pairs are the bits shared by the two reference masks.
+ */
+
+#include "Kernels.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KERNELS_X86
+#endif
+
+using namespace::std;
+
+// Scalar reference versions; also used for the tails of the vector loops
+static SLabelCounts LabelsScalar(const int *x, const int *y, int n) {
+	SLabelCounts ret;
+	for(int i = 0; i < n; i++) {
+		if((x[i] | y[i]) < 0) { continue; }
+		ret.both++;
+		if(x[i] == y[i]) { ret.same++; }
+	}
+	return ret;
+}
+static long long CommonScalar(const uint64_t *a, const uint64_t *b, int words) {
+	long long count = 0;
+	for(int w = 0; w < words; w++) { count += __builtin_popcountll(a[w] & b[w]); }
+	return count;
+}
+
+#ifdef KERNELS_X86
+// SSE2: the compare masks are all ones (-1) per lane, so subtracting them counts. Lane counters hold at most n/4
+static SLabelCounts LabelsSSE2(const int *x, const int *y, int n) {
+	__m128i both = _mm_setzero_si128(), same = _mm_setzero_si128(), minus1 = _mm_set1_epi32(-1);
+	int i = 0;
+	for(; i + 4 <= n; i += 4) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(x + i)), b = _mm_loadu_si128((const __m128i *)(y + i));
+		__m128i present = _mm_cmpgt_epi32(_mm_or_si128(a, b), minus1);
+		both = _mm_sub_epi32(both, present);
+		same = _mm_sub_epi32(same, _mm_and_si128(present, _mm_cmpeq_epi32(a, b)));
+	}
+	int lanes[8];
+	_mm_storeu_si128((__m128i *)lanes, both);
+	_mm_storeu_si128((__m128i *)(lanes + 4), same);
+	SLabelCounts ret = LabelsScalar(x + i, y + i, n - i);
+	ret.both += (long long)lanes[0] + lanes[1] + lanes[2] + lanes[3];
+	ret.same += (long long)lanes[4] + lanes[5] + lanes[6] + lanes[7];
+	return ret;
+}
+__attribute__((target("avx2")))
+static SLabelCounts LabelsAVX2(const int *x, const int *y, int n) {
+	__m256i both = _mm256_setzero_si256(), same = _mm256_setzero_si256(), minus1 = _mm256_set1_epi32(-1);
+	int i = 0;
+	for(; i + 8 <= n; i += 8) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)(x + i)), b = _mm256_loadu_si256((const __m256i *)(y + i));
+		__m256i present = _mm256_cmpgt_epi32(_mm256_or_si256(a, b), minus1);
+		both = _mm256_sub_epi32(both, present);
+		same = _mm256_sub_epi32(same, _mm256_and_si256(present, _mm256_cmpeq_epi32(a, b)));
+	}
+	int lanes[16];
+	_mm256_storeu_si256((__m256i *)lanes, both);
+	_mm256_storeu_si256((__m256i *)(lanes + 8), same);
+	SLabelCounts ret = LabelsScalar(x + i, y + i, n - i);
+	for(int l = 0; l < 8; l++) { ret.both += lanes[l]; ret.same += lanes[l + 8]; }
+	return ret;
+}
+// AVX-512 compares straight into mask registers, which are popcounted. Tails use masked loads instead of the scalar loop
+__attribute__((target("avx512f,avx512bw,popcnt")))
+static SLabelCounts LabelsAVX512(const int *x, const int *y, int n) {
+	SLabelCounts ret;
+	__m512i zero = _mm512_setzero_si512();
+	for(int i = 0; i < n; i += 16) {
+		__mmask16 valid = (n - i >= 16) ? (__mmask16)0xFFFF : (__mmask16)((1u << (n - i)) - 1);
+		__m512i a = _mm512_maskz_loadu_epi32(valid, x + i), b = _mm512_maskz_loadu_epi32(valid, y + i);
+		__mmask16 present = _mm512_mask_cmpge_epi32_mask(valid, _mm512_or_si512(a, b), zero);
+		ret.both += _mm_popcnt_u32(present);
+		ret.same += _mm_popcnt_u32(_mm512_mask_cmpeq_epi32_mask(present, a, b));
+	}
+	return ret;
+}
+
+// The reference masks are short (one bit per reference column), so the hardware popcount is all that is needed beyond the scalar loop
+__attribute__((target("popcnt")))
+static long long CommonPopcnt(const uint64_t *a, const uint64_t *b, int words) {
+	long long count = 0;
+	for(int w = 0; w < words; w++) { count += _mm_popcnt_u64(a[w] & b[w]); }
+	return count;
+}
+#endif
+
+static vector <SPairKernel> AvailableKernels() {
+	vector <SPairKernel> kernels;
+	kernels.push_back({ "scalar", LabelsScalar, CommonScalar });
+#ifdef KERNELS_X86
+	__builtin_cpu_init();
+	bool popcnt = __builtin_cpu_supports("popcnt");
+	kernels.push_back({ "sse2", LabelsSSE2, popcnt ? CommonPopcnt : CommonScalar });
+	if(__builtin_cpu_supports("avx2")) { kernels.push_back({ "avx2", LabelsAVX2, popcnt ? CommonPopcnt : CommonScalar }); }
+	if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && popcnt) {
+		kernels.push_back({ "avx512", LabelsAVX512, CommonPopcnt });
+	}
+#endif
+	return kernels;
+}
+
+const vector <SPairKernel> &PairKernels() {
+	static const vector <SPairKernel> kernels = AvailableKernels();
+	return kernels;
+}
+
+const SPairKernel &PairKernel() {
+	static const SPairKernel &kernel = PairKernels().back();
+	return kernel;
+}
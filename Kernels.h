@@ -0,0 +1,30 @@
+/*
+ * Kernels.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Vectorised counting kernels for comparing a pair of sequences. SSE2 is the baseline (the Makefile builds with -msse2) and
+ *	AVX2/AVX-512 versions are chosen at run time when the CPU supports them
+ */
+
+#ifndef KERNELS_H_
+#define KERNELS_H_
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Counts from a pair of label arrays (see CAlignStore::Labels)
+struct SLabelCounts {
+	long long both = 0;		// Columns where both labels are >= 0, i.e. a test pair with both characters in the reference
+	long long same = 0;		// Of those, the columns where the labels are equal (true positives)
+};
+
+struct SPairKernel {
+	std::string name;
+	SLabelCounts (*labels)(const int *x, const int *y, int n);		// Counts for two label arrays of length n
+	long long (*common)(const uint64_t *a, const uint64_t *b, int words);	// Number of bits set in both masks
+};
+const std::vector <SPairKernel> &PairKernels();		// Every kernel the CPU can run, from the scalar reference to the widest
+const SPairKernel &PairKernel();					// The widest kernel available; picked once on first use
+
+#endif /* KERNELS_H_ */
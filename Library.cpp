@@ -0,0 +1,68 @@
+/*
+ * Library.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	The scoring interface of libmsascorer.a, for programs that score alignments they hold in memory
+ */
+
+#include "Library.h"
+#include <memory>
+
+using namespace::std;
+
+// Checked, ready to index
+static vector <CSequence> &PreparedReference(vector <CSequence> &ref) {
+	if(ref.empty()) { throw CError("\nError: the reference MSA has no sequences\n"); }
+	CheckLengths(ref, "reference");
+	return ref;
+}
+
+CScoringReference::CScoringReference(const vector <SNamedSeq> &ref, const SAlphabet &alphabet, long long memoryBudget) : CScoringReference(MakeAlignment(ref), alphabet, memoryBudget) { }
+CScoringReference::CScoringReference(vector <CSequence> &&ref, const SAlphabet &alphabet, long long memoryBudget) : _index(PreparedReference(ref), alphabet, memoryBudget) { }
+
+vector <CSequence> MakeAlignment(const vector <SNamedSeq> &rows) {
+	vector <CSequence> retSeq;
+	retSeq.reserve(rows.size());
+	for(auto &r : rows) { retSeq.push_back(CSequence(string(r.name.data, r.name.size), string(r.seq.data, r.seq.size))); }
+	return retSeq;
+}
+
+// The test rows are released once the store is built, as the scoring only reads the store
+static unique_ptr <CAlignStore> MakeStore(vector <CSequence> &&test, const CScoringReference &ref, const TWarning &warning, long long memoryBudget) {
+	vector <CSequence> rows(move(test));
+	if(rows.empty()) { throw CError("\nError: the test MSA has no sequences\n"); }
+	CheckMatched(rows, ref.Index());
+	return unique_ptr <CAlignStore>(new CAlignStore(rows, ref.Index(), warning, memoryBudget));
+}
+static void CheckGaps(const SScoreOptions &options, const CScoringReference &ref) {
+	if(!SameGaps(options.alphabet, ref.Index().Alphabet())) { throw CError("\nError: the reference was indexed with other gap characters than the options give\n"); }
+}
+SScore ScoreAlignment(vector <CSequence> &&test, const CScoringReference &ref, const SScoreOptions &options) {
+	if(options.shards > 1 && (options.engine != Pairs || options.pairs != nullptr)) {
+		throw CError("\nError: a shard can only be scored with the pairs engine, without pair scores\n");
+	}
+	CheckGaps(options, ref);
+	unique_ptr <CAlignStore> store(MakeStore(move(test), ref, options.warning, options.memoryBudget));
+	if(options.shards > 1) { return ScorePairShard(*store, options.shard, options.shards, options.threads); }
+	return Score(*store, options.engine, options.threads, options.pairs);
+}
+SScore ScoreAlignment(const vector <SNamedSeq> &test, const CScoringReference &ref, const SScoreOptions &options) {
+	return ScoreAlignment(MakeAlignment(test), ref, options);
+}
+SScore ScoreAlignment(const vector <SNamedSeq> &test, const vector <SNamedSeq> &ref, const SScoreOptions &options) {
+	return ScoreAlignment(MakeAlignment(test), CScoringReference(ref, options.alphabet, options.memoryBudget), options);
+}
+SMetrics MeasureAlignment(vector <CSequence> &&test, const CScoringReference &ref, const SScoreOptions &options) {
+	CheckGaps(options, ref);
+	unique_ptr <CAlignStore> store(MakeStore(move(test), ref, options.warning, options.memoryBudget));
+	SMetrics metrics = ScoreMetrics(*store);
+	if(options.engine == Check && !(Score(*store, Check, options.threads) == metrics.score)) {
+		throw CError("\nError: the metrics and pair engines give different scores\n");
+	}
+	return metrics;
+}
+SSampledScore SampleAlignment(vector <CSequence> &&test, const CScoringReference &ref, const SSampleOptions &options) {
+	unique_ptr <CAlignStore> store(MakeStore(move(test), ref, options.warning, options.memoryBudget));
+	return SampleScore(*store, options);
+}
@@ -0,0 +1,68 @@
+/*
+ * Library.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	The scoring interface of libmsascorer.a, for programs that score alignments they hold in memory
+ *	---
+ *	Alignments are passed as name/sequence spans, one per aligned row, which are copied so the caller's buffers only need to
+ *	last for the call. Rows are matched between test and reference by name, in any order. Nothing is kept between calls
+ *	except a CScoringReference the caller owns and can share between threads, so calls can be made from any number of
+ *	threads at once. Problems are thrown as CError; the library never exits the process, and warnings go to the callback
+ *	in the options rather than being printed. The gaps are those of the alphabet in the options (Alphabet.h), LEGACY_GAPS
+ *	unless given, and a reference is indexed with the gaps it is scored with. Allocations are only counted (for -engine check) in programs that also link Allocations.o. Link with -lz.
+ */
+
+#ifndef LIBRARY_H_
+#define LIBRARY_H_
+#include "Scorer.h"
+#include "Sampling.h"
+#include "Metrics.h"
+#include <string>
+#include <vector>
+
+// A run of characters owned by the caller
+struct SSpan {
+	const char *data = nullptr;
+	size_t size = 0;
+	SSpan() { }
+	SSpan(const char *d, size_t s) : data(d), size(s) { }
+	SSpan(const std::string &s) : data(s.data()), size(s.size()) { }
+};
+struct SNamedSeq {
+	SSpan name;
+	SSpan seq;			// The aligned row, gaps included
+};
+
+struct SScoreOptions {
+	EEngine engine = Pairs;
+	int threads = 1;						// Threads for the pair engine
+	const CPairWriter *pairs = nullptr;		// If given, the score of every pair is written to it (pairs and check engines)
+	int shard = 0, shards = 1;				// With several shards, only shard's slice of the pairs is scored (pairs engine, no pairs)
+	SAlphabet alphabet;						// Must have the gaps of the CScoringReference, when one is given
+	TWarning warning;						// Passed the warnings, such as a reference fragment found twice in a test row
+	long long memoryBudget = 0;				// Bytes the process may use, checked before the large allocations (CheckMemory); 0 for no limit
+};
+
+// A reference MSA checked and indexed once, for scoring any number of test MSAs against it
+class CScoringReference {
+public:
+	CScoringReference(const std::vector <SNamedSeq> &ref, const SAlphabet &alphabet = SAlphabet(), long long memoryBudget = 0);
+	CScoringReference(std::vector <CSequence> &&ref, const SAlphabet &alphabet = SAlphabet(), long long memoryBudget = 0);	// Sequences as read from a file, in any order
+	int Size() const { return _index.Size(); }
+	int Length() const { return _index.Length(); }
+	const CRefIndex &Index() const { return _index; }		// Rows in the order given
+private:
+	CRefIndex _index;
+};
+
+std::vector <CSequence> MakeAlignment(const std::vector <SNamedSeq> &rows);
+SScore ScoreAlignment(std::vector <CSequence> &&test, const CScoringReference &ref, const SScoreOptions &options = SScoreOptions());
+SScore ScoreAlignment(const std::vector <SNamedSeq> &test, const CScoringReference &ref, const SScoreOptions &options = SScoreOptions());
+SScore ScoreAlignment(const std::vector <SNamedSeq> &test, const std::vector <SNamedSeq> &ref, const SScoreOptions &options = SScoreOptions());
+// Estimates the pair totals from a sample of the pairs (see Sampling.h)
+SSampledScore SampleAlignment(std::vector <CSequence> &&test, const CScoringReference &ref, const SSampleOptions &options = SSampleOptions());
+// Scores the alignment with ScoreMetrics (see Metrics.h). With the check engine the totals are also compared with the pair engine's
+SMetrics MeasureAlignment(std::vector <CSequence> &&test, const CScoringReference &ref, const SScoreOptions &options = SScoreOptions());
+
+#endif /* LIBRARY_H_ */
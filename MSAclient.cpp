@@ -0,0 +1,111 @@
+/*
+ * MSAclient
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Client for msascorer running in server mode (msascorer -server Socket). Takes the same arguments as msascorer for a single
+ *	comparison and prints the same output, but the reading and scoring are done by the server, which keeps the references
+ *	it has indexed in memory
+ */
+
+#include "Server.h"
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace::std;
+
+// The server may be running elsewhere in the file system, so files are sent as absolute paths
+static string AbsolutePath(const string &file) {
+	char *path = realpath(file.c_str(), NULL);
+	if(path == NULL) { cerr << "Error opening '"<< file <<"'. Provide a valid file." << endl; exit(-1); }
+	string ret = path;
+	free(path);
+	return ret;
+}
+
+static int Connect(const string &socketPath) {
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(socketPath.size() >= sizeof(address.sun_path) || fd < 0) { cerr << "\nError: cannot use socket " << socketPath << "\n"; exit(-1); }
+	strcpy(address.sun_path, socketPath.c_str());
+	if(connect(fd, (struct sockaddr *)&address, sizeof(address)) != 0) {
+		cerr << "\nError: cannot connect to an msascorer server on " << socketPath << ": " << strerror(errno);
+		cerr << "\nStart one with: msascorer -server " << socketPath << "\n";
+		exit(-1);
+	}
+	return fd;
+}
+
+int main(int argc, char * argv[]) {
+	string testFile, refFile, engine, threads, socketPath;
+	if(getenv("MSASCORER_SOCKET") != NULL) { socketPath = getenv("MSASCORER_SOCKET"); }
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-h") == 0) { testFile.clear(); refFile.clear(); break; }
+		else if(strcmp(argv[i], "-engine") == 0 && i + 1 < argc) { engine = argv[++i]; }
+		else if(strcmp(argv[i], "-t") == 0 && i + 1 < argc) { threads = argv[++i]; }
+		else if(strcmp(argv[i], "-socket") == 0 && i + 1 < argc) { socketPath = argv[++i]; }
+		// The server only takes the options above, so any other is refused rather than read as a file name
+		else if(argv[i][0] == '-' && argv[i][1] != '\0') {
+			cout << "\nError: " << argv[i] << " is not available through the client; run msascorer directly\n"; exit(-1);
+		}
+		else if(testFile.empty()) { testFile = argv[i]; }
+		else if(refFile.empty()) { refFile = argv[i]; }
+		else { cout << "\nError: unexpected argument " << argv[i] << "\n"; exit(-1); }
+	}
+	if(refFile.empty()) {
+		cout << "\n===================================================================";
+		cout << "\n\tMSAscorer client";
+		cout << "\n===================================================================";
+		cout << "\n\nUsage: msascorer-client [-engine pairs|columns|check] [-t N] [-socket Socket] TestMSA RefMSA";
+		cout << "\n\nSends the comparison to a server started with \"msascorer -server Socket\" and prints the same output as";
+		cout << "\nmsascorer. The socket is given by -socket, or MSASCORER_SOCKET, or is " << defaultSocket << ".";
+		cout << "\nA TestMSA of - is read from standard input and sent to the server with the request. Other msascorer options";
+		cout << "\n(-alphabet, -gaps, -metrics, -sample, -shard, ...) are not available through the client.";
+		cout << "\n\nType \"./msascorer -h\" for the options and the output\n\n";
+		exit(-1);
+	}
+	if(socketPath.empty()) { socketPath = defaultSocket; }
+
+	// Build the request
+	ostringstream request;
+	string data;
+	if(testFile == "-") {
+		data.assign(istreambuf_iterator<char>(cin), istreambuf_iterator<char>());
+		request << "inline " << data.size() << "\n";
+	} else {
+		request << "test " << AbsolutePath(testFile) << "\n";
+	}
+	request << "testname " << testFile << "\nref " << AbsolutePath(refFile) << "\nrefname " << refFile << "\n";
+	if(!engine.empty()) { request << "engine " << engine << "\n"; }
+	if(!threads.empty()) { request << "threads " << threads << "\n"; }
+	request << "\n" << data;
+
+	// Send it and print the reply
+	int fd = Connect(socketPath);
+	string out = request.str();
+	for(size_t sent = 0; sent < out.size(); ) {
+		ssize_t put = send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+		if(put <= 0) { cerr << "\nError: lost the connection to the server\n"; exit(-1); }
+		sent += put;
+	}
+	string reply;
+	char block[1 << 16];
+	ssize_t got;
+	while((got = recv(fd, block, sizeof(block), 0)) > 0) { reply.append(block, got); }
+	close(fd);
+	size_t body = reply.find('\n');
+	if(body == string::npos) { cerr << "\nError: no reply from the server\n"; exit(-1); }
+	if(reply.compare(0, 3, "OK ") != 0) { cerr << reply.substr(body + 1); exit(-1); }
+	cout << reply.substr(body + 1);
+	return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * MSApairs
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Reader for the pair score files written by msascorer -pairs (see PairFile.h)
+ *
+ *	Usage: msapairs PairFile [-row Name|Index ...] [-worst K]
+ *		With -row, prints the pairs of each sequence given, reading only those records.
+ *		Otherwise prints each sequence's totals over all its pairs, in file order or, with -worst, the K sequences with the
+ *		most FalsePos + FalseNeg first. Output is tab separated with a header line
+ */
+
+#include "PairFile.h"
+#include "Sequence.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+
+using namespace::std;
+
+static void WriteRecord(const string &name, long long TP, long long FP, long long FN, long long totalRef) {
+	cout << name << "\t" << TP << "\t" << FP << "\t" << FN << "\t" << totalRef << "\n";
+}
+
+int main(int argc, char *argv[]) {
+	string file;
+	vector <string> rows;
+	int worst = -1;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-row") == 0 && i + 1 < argc) { rows.push_back(argv[++i]); }
+		else if(strcmp(argv[i], "-worst") == 0 && i + 1 < argc) { worst = atoi(argv[++i]); }
+		else if(file.empty()) { file = argv[i]; }
+		else { cerr << "\nError: unexpected argument " << argv[i] << "\n"; return -1; }
+	}
+	if(file.empty()) { cerr << "\nUsage: msapairs PairFile [-row Name|Index ...] [-worst K]\n\n"; return -1; }
+	try {
+		CPairReader pairs(file);
+		int n = pairs.Size();
+		if(!rows.empty()) {
+			vector <SPairRecord> row;
+			cout << "#Sequence\tOther\tTruePos\tFalsePos\tFalseNeg\ttotalRef\n";
+			for(auto &r : rows) {
+				int i = pairs.Find(r);
+				if(i < 0 && !r.empty() && all_of(r.begin(), r.end(), ::isdigit)) { i = atoi(r.c_str()); }
+				if(i < 0 || i >= n) { throw CError("\nError: no sequence " + r + " in " + file + "\n"); }
+				pairs.Row(i, row);
+				for(int j = 0; j < n; j++) {
+					if(j != i) { WriteRecord(pairs.Name(i) + "\t" + pairs.Name(j), row[j].TP, row[j].FP, row[j].FN, row[j].totalRef); }
+				}
+			}
+			return 0;
+		}
+		// Totals per sequence, reading the records in file order
+		vector <long long> TP(n, 0), FP(n, 0), FN(n, 0), totalRef(n, 0);
+		for(int i = 0; i < n; i++) {
+			for(int j = i + 1; j < n; j++) {
+				const SPairRecord &r = pairs.Pair(i, j);
+				for(int k : { i, j }) { TP[k] += r.TP; FP[k] += r.FP; FN[k] += r.FN; totalRef[k] += r.totalRef; }
+			}
+		}
+		vector <int> order(n);
+		iota(order.begin(), order.end(), 0);
+		if(worst >= 0) {
+			stable_sort(order.begin(), order.end(), [&](int a, int b) { return FP[a] + FN[a] > FP[b] + FN[b]; });
+			order.resize(my_min(worst, n));
+		}
+		cout << "#Sequence\tTruePos\tFalsePos\tFalseNeg\ttotalRef\n";
+		for(int i : order) { WriteRecord(pairs.Name(i), TP[i], FP[i], FN[i], totalRef[i]); }
+	} catch(CError &e) {
+		cerr << e.what();
+		return -1;
+	}
+	return 0;
+}
@@ -9,38 +9,86 @@
 
 
 #include <algorithm>
+#include <cstring>
 #include "Sequence.h"
+#include "Library.h"
+#include "Parallel.h"
+#include "Server.h"
+#include "Profile.h"
+#include "PairFile.h"
+#include "Shard.h"
 #include <iomanip>
+#include <memory>
+#include <glob.h>
 
 using namespace::std;
 
-// Global variables. Ugly, but easiest quick solution
-vector <CSequence> *testData = NULL;
-vector <CSequence> *refData = NULL;
-vector <vector <string> > seqBlock;		// The blocks of divvied sequences to sample from
-string gapChar = "*-X?";
+// The library hands its warnings back rather than printing them
+static void PrintWarning(const string &message) {
+	cout.flush();
+	cerr << message;
+}
 
-struct SScore {
-	int TP = 0;				// Number of true pairs
-	int FP = 0;
-	int FN = 0;				// Number of pairs not captured in true alignment
-	int totalRef = 0;		// Number pairs in reference alignment
-	int totalTest = 0;		// Total number of pairs in test alignment
-	SScore operator+=(const SScore &S) {
-		TP += S.TP;
-		FP += S.FP;
-		FN += S.FN;
-		totalRef += S.totalRef;
-		totalTest += S.totalTest;
-		return *this;
+// The test MSAs for batch mode: a glob pattern, or a manifest file listing one path per line (blank lines and # comments are ignored)
+static vector <string> BatchFiles(const string &tests) {
+	vector <string> files;
+	if(tests.find_first_of("*?[") != string::npos) {
+		glob_t found;
+		if(glob(tests.c_str(), 0, NULL, &found) == 0) {
+			for(size_t i = 0; i < found.gl_pathc; i++) { files.push_back(found.gl_pathv[i]); }
+		}
+		globfree(&found);
+	} else {
+		ifstream manifest(tests.c_str());
+		if(!manifest.good()) { throw CError("Error opening '" + tests + "'. Provide a valid file.\n"); }
+		string line;
+		while(getline(manifest, line)) {
+			line = RemoveWhiteSpace(line);
+			if(!line.empty() && line[0] != '#') { files.push_back(line); }
+		}
 	}
-};
+	if(files.empty()) { throw CError("\nError: no test MSAs found in " + tests + "\n"); }
+	return files;
+}
 
-SScore ComparePairs(tuple<string, string> s1, tuple<string, string> s2); // Compare sequences s1/s2 with <test,ref> for each
-string RemoveGaps(string &seq);
-tuple<vector<int>,vector<int>> MapPositions(string &x, string &y, string &z); // Maps x to y, with -1 for cases where x doesn't occur in y; uses the second reference sequence z to ignore gaps
-vector <tuple<int,int>> MakePairs(vector<int> &x,vector<int> &y);
-int CountTP(vector <tuple<int,int> > &x);
+// Score every test MSA in the batch against one reference. The reference is read, checked and indexed once, and jobs test
+// MSAs are scored at a time. Results are printed in batch order with one row per test MSA; a test MSA that cannot be scored
+// gets a row marked error and its message is printed after the table. Returns whether every test MSA was scored
+static bool Batch(const string &tests, const string &refFile, EEngine engine, int threads, int jobs, bool detect, const string &gaps, SAlphabet &alphabet, long long memoryBudget) {
+	vector <string> files = BatchFiles(tests);
+	unique_ptr <vector <CSequence> > refData(ReadAlignment(refFile, threads, alphabet, PrintWarning, memoryBudget));
+	if(detect) { alphabet = MakeAlphabet(DetectAlphabet(*refData, alphabet), gaps); }
+	CScoringReference ref(move(*refData), alphabet, memoryBudget);
+	refData.reset();
+	SScoreOptions options;
+	options.engine = engine;
+	options.threads = threads;
+	options.alphabet = alphabet;
+	options.warning = PrintWarning;
+	options.memoryBudget = memoryBudget;
+	cout << "#Batch of " << files.size() << " test MSAs => REF " << refFile << "(seq:" << ref.Size() << ";l=" << ref.Length() << ")";
+	vector <SScore> scores(files.size());
+	vector <string> errors(files.size());
+	ParallelFor(files.size(), jobs, [&](int k) {
+		try {
+			unique_ptr <vector <CSequence> > test(ReadAlignment(files[k], threads, alphabet, PrintWarning, memoryBudget));
+			scores[k] = ScoreAlignment(move(*test), ref, options);
+		} catch(CError &e) { errors[k] = e.what(); }
+	});
+	int width = 15, nameWidth = width;
+	for(auto &f : files) { nameWidth = my_max(nameWidth, (int)f.size() + 2); }
+	cout << left << "\n" << setw(nameWidth) << "#TestMSA" << setw(width)<< "TruePos"<< setw(width) <<"FalsePos"<< setw(width) <<"FalseNeg"<< setw(width) <<"totalRef";
+	for(size_t k = 0; k < files.size(); k++) {
+		if(!errors[k].empty()) { cout << "\n" << setw(nameWidth) << files[k] << "error"; continue; }
+		cout << "\n" << setw(nameWidth) << files[k] << setw(width) << scores[k].TP << setw(width) << scores[k].FP << setw(width) << scores[k].FN << setw(width) << scores[k].totalRef;
+	}
+	cout << "\n";
+	bool scored = true;
+	for(size_t k = 0; k < files.size(); k++) {
+		if(!errors[k].empty()) { cerr << "\nError scoring " << files[k] << ":" << errors[k]; scored = false; }
+	}
+	return scored;
+}
 
 int main(int argc, char * argv[]) {
 	SScore score;
@@ -51,7 +99,43 @@ int main(int argc, char * argv[]) {
 			cout << "\n\tMSAscorer : written by Simon Whelan";
 			cout << "\n===================================================================";
 			cout << "\n\nUsage: msascorer TestMSA RefMSA";
-			cout << "\n\nTestMSA.fas / RefMSA.fas can be in FASTA/MSF/Phylip/Interleaved format";
+			cout << "\n\nTestMSA.fas / RefMSA.fas can be in FASTA/MSF/Phylip/Interleaved format, gzip compressed or not. Either can be - to";
+			cout << "\nread it from stdin, e.g. aligner | msascorer - RefMSA.fas";
+			cout << "\n\nOptions:";
+			cout << "\n\t-engine pairs|columns|check : how the totals are computed. pairs (default) compares every pair of sequences;";
+			cout << "\n\t\tcolumns builds them from per-column tallies in time linear in the number of sequences;";
+			cout << "\n\t\tcheck runs both and fails if they disagree, or if comparing the pairs allocated any memory";
+			cout << "\n\t-t N : number of threads for reading large files and the pairwise comparison (default 1; 0 uses all cores)";
+			cout << "\n\t-batch Manifest|\"Glob\" : score many test MSAs against one RefMSA, which is read and indexed once. The test MSAs are";
+			cout << "\n\t\tlisted one per line in Manifest, or matched by a quoted glob pattern. One result row is written per test MSA";
+			cout << "\n\t-j N : number of test MSAs to score at once in batch mode (default 1; 0 uses all cores)";
+			cout << "\n\t-server Socket : run as a server answering requests on the Unix domain socket instead of comparing files.";
+			cout << "\n\t\tParsed and indexed references are kept in memory between requests. msascorer-client takes the same";
+			cout << "\n\t\targuments as msascorer and sends the comparison to the server (socket from -socket or MSASCORER_SOCKET)";
+			cout << "\n\t-cache N : number of references the server keeps in memory (default 8)";
+			cout << "\n\t-alphabet protein|dna|rna|auto : the residues expected (default auto, detected from the test MSA, or the";
+			cout << "\n\t\treference in batch mode, when -profile reports it; protein in server mode). All use the gap characters";
+			cout << "\n\t\t" << LEGACY_GAPS << " so scores are the same";
+			cout << "\n\t-gaps Chars : the characters counted as gaps instead of " << LEGACY_GAPS;
+			cout << "\n\t-profile[=File] : report the time spent in each phase (format sniffing, reading, matching names, checking, mapping,";
+			cout << "\n\t\tpairs, columns), counts of sequences, residues, pairs and bytes read, and the peak memory use.";
+			cout << "\n\t\tThe report is JSON written to stderr after the normal output, or to File";
+			cout << "\n\t-mem-budget Size : fail at once, saying what did not fit, if reading the inputs, indexing the reference or";
+			cout << "\n\t\tbuilding the alignment store would take the process over Size (in MB, or with a K, M or G suffix). The";
+			cout << "\n\t\tpeak memory use is written to stderr at the end, so later jobs can be sized from it";
+			cout << "\n\t-pairs File : also write the TruePos, FalsePos, FalseNeg and totalRef of every pair of sequences to the binary";
+			cout << "\n\t\tFile as the pairs are compared (pairs or check engine). Read it with msapairs";
+			cout << "\n\t-metrics List : also score the comparison as a comma separated List of sp (TruePos / totalRef), modeler";
+			cout << "\n\t\t(TruePos / (TruePos + FalsePos)), tc (fraction of reference columns of two or more characters that the";
+			cout << "\n\t\ttest aligns exactly), columns (the pairs of each reference column and how many the test aligns) or all.";
+			cout << "\n\t\tAll are computed in one pass over the columns and written after the totals (single comparison only)";
+			cout << "\n\t-sample Precision : estimate the totals from a random sample of the pairs, for very deep alignments. Pairs are";
+			cout << "\n\t\tdrawn until the 95% confidence interval of each total is within +/- Precision * totalRef (e.g. 0.001),";
+			cout << "\n\t\twhich are written on a line after the totals (pairs engine, single comparison only)";
+			cout << "\n\t-shard k/n File : score only the k-th of n equal slices of the pairs (pairs engine, single comparison only) and";
+			cout << "\n\t\twrite the partial totals, with checksums of the inputs, to File. Run each of k = 1..n, on any machines, then";
+			cout << "\n\t\tmsascorer merge File ... checks that the files are all n shards of the same inputs and prints the totals";
+			cout << "\n\t-seed N : seed for -sample (default 1); the same seed gives the same estimate on any number of threads";
 			cout << "\n\nResults will look like this:\n";
 			cout << "\n#Comparing TestMSA.fas (seq:4;l=112) => REF RefMSA.fas(seq:4;l=78)";
 			cout << "\n#TruePos       FalsePos       FalseNeg       totalRef ";
@@ -68,132 +152,198 @@ int main(int argc, char * argv[]) {
 			exit(-1);
 		}
 	}
-	if(argc < 3) {
+	if(argc > 1 && strcmp(argv[1], "merge") == 0) {
+		try {
+			SShard merged = MergeShards(vector <string>(argv + 2, argv + argc));
+			WriteComparing(cout, merged.test.file, merged.test.sequences, merged.test.length, merged.ref.file, merged.ref.sequences, merged.ref.length);
+			WriteScore(cout, merged.score);
+		} catch(CError &e) {
+			cout.flush();
+			cerr << e.what();
+			return -1;
+		}
+		return 0;
+	}
+	// Options
+	string testFile, refFile, batchFile, socketFile, profileFile, pairsFile, shardFile, alphabetName = "auto", gaps;
+	EEngine engine = Pairs;
+	int threads = 1, jobs = 1, cacheSize = 8, shard = 0, shards = 1;
+	long long memoryBudget = 0;				// Bytes the process may use, from -mem-budget; 0 for no limit
+	unsigned metrics = 0;
+	SSampleOptions sample;
+	sample.precision = 0;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-engine") == 0 && i + 1 < argc) {
+			string e = argv[++i];
+			if(e == "pairs") { engine = Pairs; }
+			else if(e == "columns") { engine = Columns; }
+			else if(e == "check") { engine = Check; }
+			else { cout << "\nError: unknown engine " << e << " (expected pairs, columns or check)\n"; exit(-1); }
+		}
+		else if(strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+			threads = atoi(argv[++i]);
+			if(threads < 0) { cout << "\nError: -t expects the number of threads (0 for all cores)\n"; exit(-1); }
+		}
+		else if(strcmp(argv[i], "-batch") == 0 && i + 1 < argc) { batchFile = argv[++i]; }
+		else if(strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			jobs = atoi(argv[++i]);
+			if(jobs < 0) { cout << "\nError: -j expects the number of test MSAs to score at once (0 for all cores)\n"; exit(-1); }
+		}
+		else if(strcmp(argv[i], "-server") == 0 && i + 1 < argc) { socketFile = argv[++i]; }
+		else if(strcmp(argv[i], "-alphabet") == 0 && i + 1 < argc) {
+			alphabetName = argv[++i];
+			if(alphabetName != "auto" && alphabetName != "protein" && alphabetName != "dna" && alphabetName != "rna") {
+				cout << "\nError: unknown alphabet " << alphabetName << " (expected protein, dna, rna or auto)\n"; exit(-1);
+			}
+		}
+		else if(strcmp(argv[i], "-gaps") == 0 && i + 1 < argc) {
+			gaps = argv[++i];
+			if(gaps.empty()) { cout << "\nError: -gaps expects the gap characters\n"; exit(-1); }
+		}
+		else if(strncmp(argv[i], "-profile", 8) == 0 || strncmp(argv[i], "--profile", 9) == 0) {
+			const char *file = strchr(argv[i], '=');
+			string flag = file == NULL ? string(argv[i]) : string(argv[i], file - argv[i]);
+			if(flag != "-profile" && flag != "--profile") { cout << "\nError: unexpected argument " << argv[i] << "\n"; exit(-1); }
+			if(file != NULL) { profileFile = file + 1; }
+			StartProfile();
+		}
+		else if(strcmp(argv[i], "-pairs") == 0 && i + 1 < argc) { pairsFile = argv[++i]; }
+		else if(strcmp(argv[i], "-mem-budget") == 0 && i + 1 < argc) {
+			char *unit;
+			double size = strtod(argv[++i], &unit);
+			string suffix = unit;
+			double scale = suffix == "K" || suffix == "k" ? 1024.0 : suffix == "" || suffix == "M" || suffix == "m" ? 1048576.0 : suffix == "G" || suffix == "g" ? 1073741824.0 : 0;
+			if(!(size > 0) || scale == 0) { cout << "\nError: -mem-budget expects a size in MB, or with a K, M or G suffix\n"; exit(-1); }
+			memoryBudget = (long long)(size * scale);
+		}
+		else if(strcmp(argv[i], "-metrics") == 0 && i + 1 < argc) {
+			metrics = ParseMetrics(argv[++i]);
+			if(metrics == 0) { cout << "\nError: -metrics expects a comma separated list of sp, tc, modeler, columns or all\n"; exit(-1); }
+		}
+		else if(strcmp(argv[i], "-sample") == 0 && i + 1 < argc) {
+			sample.precision = atof(argv[++i]);
+			if(!(sample.precision > 0)) { cout << "\nError: -sample expects the precision wanted, as a fraction of totalRef (e.g. 0.001)\n"; exit(-1); }
+		}
+		else if(strcmp(argv[i], "-shard") == 0 && i + 2 < argc) {
+			char extra;
+			if(sscanf(argv[++i], "%d/%d%c", &shard, &shards, &extra) != 2 || shards < 1 || shard < 1 || shard > shards) {
+				cout << "\nError: -shard expects k/n with 1 <= k <= n, then the file for the partial totals\n"; exit(-1);
+			}
+			shard--;
+			shardFile = argv[++i];
+		}
+		else if(strcmp(argv[i], "-seed") == 0 && i + 1 < argc) { sample.seed = strtoull(argv[++i], NULL, 10); }
+		else if(strcmp(argv[i], "-cache") == 0 && i + 1 < argc) {
+			cacheSize = atoi(argv[++i]);
+			if(cacheSize < 1) { cout << "\nError: -cache expects the number of references to keep (at least 1)\n"; exit(-1); }
+		}
+		else if(testFile.empty() && batchFile.empty()) { testFile = argv[i]; }
+		else if(refFile.empty()) { refFile = argv[i]; }
+		else { cout << "\nError: unexpected argument " << argv[i] << "\n"; exit(-1); }
+	}
+	if(refFile.empty() && socketFile.empty()) {
 		cout << "\n===================================================================";
 		cout << "\n\tMSAscorer : written by Simon Whelan";
 		cout << "\n===================================================================";
-		cout << "\n\nStandard usage: msascorer TestMSA RefMSA\n\nType \"./msascorer -h\" for help\n\n";
+		cout << "\n\nStandard usage: msascorer TestMSA RefMSA\n\t or: msascorer -batch Manifest|\"Glob\" RefMSA\n\t or: msascorer -server Socket\n\nType \"./msascorer -h\" for help\n\n";
 		exit(-1);
 	}
-	// Options
-	string testFile = argv[1];
-	string refFile = argv[2];
 
-	// Read data and do some checking
-	testData = ReadSequences(testFile); // Reads the sequences
-	refData = ReadSequences(refFile);
-	sort(testData->begin(), testData->end(),[](CSequence &a, CSequence&b) { return a.Name() < b.Name(); });
-	sort(refData->begin(), refData->end(),[](CSequence &a, CSequence&b) { return a.Name() < b.Name(); });
-	if(testData->size() != refData->size()) {  cout << "\nError: test and reference MSAs have different number of sequences"; exit(-1); }
-	for(int i = 0 ; i < testData->size(); i++) {
-		if(testData->at(i).Name() != refData->at(i).Name()) { cout << "\nError: test ("<< testData->at(i).Name()<< ")and ref ("<< refData->at(i).Name() << ") have different names?\n"; exit(-1); }
+	if(testFile == "-" && refFile == "-") { cout << "\nError: only one of TestMSA and RefMSA can be read from stdin\n"; exit(-1); }
+	if(!pairsFile.empty() && (!batchFile.empty() || !socketFile.empty() || engine == Columns)) {
+		cout << "\nError: -pairs needs a single comparison with the pairs or check engine\n"; exit(-1);
 	}
-	// Check the test
-	assert(!testData->empty());
-	for(auto & s : *testData) {
-		if(s.length() != testData->at(0).length()) { cout << "\nSequences of uneven length in test MSA file\n"; exit(-1); }
+	if(sample.precision > 0 && (!batchFile.empty() || !socketFile.empty() || engine != Pairs || !pairsFile.empty())) {
+		cout << "\nError: -sample needs a single comparison with the pairs engine and no -pairs\n"; exit(-1);
 	}
-	// Check the reference
-	assert(!refData->empty());
-	for(auto & s : *refData) {
-		if(s.length() != refData->at(0).length()) { cout << "\nSequences of uneven length in reference MSA file\n"; exit(-1); }
+	if(!shardFile.empty() && (!batchFile.empty() || !socketFile.empty() || engine != Pairs || !pairsFile.empty() || sample.precision > 0)) {
+		cout << "\nError: -shard needs a single comparison with the pairs engine, without -pairs or -sample\n"; exit(-1);
 	}
-	if(refData->at(0).length() > testData->at(0).length()) {
-		cout << "\nError: reference MSA is long than test MSA\n"; exit(-1);
+	if(metrics != 0 && (!batchFile.empty() || !socketFile.empty() || !pairsFile.empty() || sample.precision > 0 || !shardFile.empty())) {
+		cout << "\nError: -metrics needs a single comparison, without -pairs, -sample or -shard\n"; exit(-1);
 	}
-	cout << "#Comparing " << testFile << " (seq:" << testData->size() << ";l=" << testData->at(0).length();
-	cout << ") => REF " << refFile << "(seq:" << refData->size() << ";l=" << refData->at(0).length() << ")";
-
-	// Do all against all comparison
-	for(int i = 0; i < testData->size(); i++) {
-		for(int j = i+1; j < testData->size(); j++) {
-			score += ComparePairs(tuple<string,string>(testData->at(i).Seq(),refData->at(i).Seq()),tuple<string,string>(testData->at(j).Seq(),refData->at(j).Seq()) );
-
+	threads = ThreadCount(threads);
+	sample.threads = threads;
+	sample.warning = PrintWarning;
+	sample.memoryBudget = memoryBudget;
+	// All the alphabets have the same gaps, so only the profile report depends on which it is and it is only detected for that
+	bool detect = alphabetName == "auto" && socketFile.empty() && profiling;
+	SAlphabet alphabet = MakeAlphabet(alphabetName == "dna" ? DNA : alphabetName == "rna" ? RNA : Protein, gaps);
+	int status = 0;
+	try {
+		if(!socketFile.empty()) {
+			RunServer(socketFile, cacheSize, threads);
+			return 0;
 		}
+		if(!batchFile.empty()) {
+			if(!Batch(batchFile, refFile, engine, threads, ThreadCount(jobs), detect, gaps, alphabet, memoryBudget)) { status = -1; }
+		} else {
+			// Read data; the checking and scoring are done by the library
+			unique_ptr <vector <CSequence> > testData(ReadAlignment(testFile, threads, alphabet, PrintWarning, memoryBudget));
+			unique_ptr <vector <CSequence> > refData(ReadAlignment(refFile, threads, alphabet, PrintWarning, memoryBudget));
+			if(detect) { alphabet = MakeAlphabet(DetectAlphabet(*testData, alphabet), gaps); }
+			int testSeq = testData->size(), testLen = testData->at(0).length();
+			SShard partial;
+			if(!shardFile.empty()) {
+				partial.shard = shard;
+				partial.shards = shards;
+				partial.test = ShardInput(testFile, *testData);
+				partial.ref = ShardInput(refFile, *refData);
+				partial.gaps = gaps.empty() ? LEGACY_GAPS : gaps;
+			}
+			CScoringReference ref(move(*refData), alphabet, memoryBudget);
+			refData.reset();
+			SScoreOptions options;
+			options.engine = engine;
+			options.threads = threads;
+			options.alphabet = alphabet;
+			options.warning = PrintWarning;
+			options.memoryBudget = memoryBudget;
+			if(sample.precision > 0) {
+				SSampledScore estimate = SampleAlignment(move(*testData), ref, sample);
+				WriteComparing(cout, testFile, testSeq, testLen, refFile, ref.Size(), ref.Length());
+				WriteSampledScore(cout, estimate, sample);
+			} else if(metrics != 0) {
+				SMetrics measured = MeasureAlignment(move(*testData), ref, options);
+				WriteComparing(cout, testFile, testSeq, testLen, refFile, ref.Size(), ref.Length());
+				WriteMetrics(cout, measured, metrics);
+			} else {
+				options.shard = shard;
+				options.shards = shards;
+				unique_ptr <CPairWriter> pairs;
+				if(!pairsFile.empty()) {
+					vector <string> names;
+					for(int i = 0; i < ref.Size(); i++) { names.push_back(ref.Index().Name(i)); }
+					pairs.reset(new CPairWriter(pairsFile, names));
+					options.pairs = pairs.get();
+				}
+				score = ScoreAlignment(move(*testData), ref, options);
+				WriteComparing(cout, testFile, testSeq, testLen, refFile, ref.Size(), ref.Length());
+				if(!shardFile.empty()) {
+					partial.score = score;
+					WriteShard(shardFile, partial);
+					cout << "\n#Partial totals of shard " << shard + 1 << " of " << shards << ", written to " << shardFile;
+				}
+				WriteScore(cout, score);
+			}
+		}
+	} catch(CError &e) {
+		cout.flush();
+		cerr << e.what();
+		status = -1;
 	}
-	int width = 15;
-	cout << left << "\n" << setw(width)<< "#TruePos"<< setw(width) <<"FalsePos"<< setw(width) <<"FalseNeg"<< setw(width) <<"totalRef";
-	cout << "\n" << setw(width) << score.TP << setw(width) << score.FP << setw(width) << score.FN << setw(width) << score.totalRef;
-	cout << "\n";
-	return 0;
-}
-
-// Compare the pairs x and y <0: test, 1: ref> and return the score
-SScore ComparePairs(tuple<string, string> seq1, tuple<string, string> seq2) {
-	SScore retScore;
-	// Get labels for each of the sequences so we can identify and compare homology pairs; Detailed in the function
-	tuple<vector<int>,vector<int>> s1_int = MapPositions(get<0>(seq1),get<1>(seq1),get<1>(seq2));
-	tuple<vector<int>,vector<int>> s2_int = MapPositions(get<0>(seq2),get<1>(seq2),get<1>(seq1));
-	// From these labels construct all of the pairs where both characters are present in the reference (defined as both labels >= 0)
-	vector <tuple<int,int> > testPairs = MakePairs(get<0>(s1_int),get<0>(s2_int));
-	vector <tuple<int,int> > refPairs = MakePairs(get<1>(s1_int),get<1>(s2_int));
-	// Transfer information to the score structure
-	retScore.totalTest = testPairs.size();
-	retScore.totalRef = refPairs.size();
-	retScore.TP = CountTP(testPairs);					// Intersection of totalTest and totalRef, but can be computed more simply
-	retScore.FN = retScore.totalRef - retScore.TP;		// FNs are the
-	retScore.FP = testPairs.size() - retScore.TP;		// FPs are the size of testPairs that are not TP
-	assert(retScore.FN >= 0);
-	return retScore;
-}
-
-// Map the reference sequence y onto the test sequence x. Uses the second reference sequence z to ensure gaps are handled correctly
-// ---
-// Each character in the pair of sequence x,y (returned in tuple<vector<int>,vector<int>>) is labelled as follows:
-// -BIG_NUMBER : Not in reference MSA (only x; all of y will be labelled)
-// -int : In the reference, but aligned to a gap
-// int : In the reference and aligned to a real character
-// The logic is commented into the code
-tuple<vector<int>,vector<int>> MapPositions(string &x, string &y, string &z) {
-	string x_clean = RemoveGaps(x);	// The raw sequences unaligned
-	string y_clean = RemoveGaps(y);
-	assert(y.size() == z.size());	// Check the aligned reference is correct
-	vector <int> y_clean_int(y_clean.size(),-BIG_NUMBER);	// Storage of character mapping
-	vector <int> x_int(x.size(),-BIG_NUMBER), y_int(y.size(),-BIG_NUMBER);		// The return vectors
-	int start_x = (int) x_clean.find(y_clean);	// Get the real character position that y starts in clean_x, recast as int
-	int end_x = start_x + y_clean.size();		// Get the positon in clean_x where y is expected to end
-	if(start_x == string::npos) { cout << "\nError: reference sequence is not a valid subset of the test sequence\ntest: " << x << "\nref:  " << y; exit(-1); }
-	// Create the map for reference (y) based on the other reference (z)
-	int pos = 0;										// Sequence position number (observable character)
-	for(int i = 0; i < y.size(); i++) {
-		if(IsGap(z[i])) { y_int[i] = -(i + 1); }				// If aligned to a gap => label as -int
-		else { y_int[i] = i + 1; }							// If aligned to a character => label as int
-		if(!IsGap(y[i])) { y_clean_int[pos++] = i + 1; }    // Transfer that number to y_clean_int for mapping to x
-	}
-	// Now build the x_int
-	pos = 0;											// Sequence position number (observable character)
-	for(int i = 0; i < x.size(); i++) {
-		if(IsGap(x[i])) { continue; }							// Don't care about gaps
-		if(pos < start_x || pos >= end_x) { pos++; continue; }	// If the observable character in x is not also in y, just skip
-		x_int[i] = y_clean_int[pos++ - start_x];				// Otherwise add the label from y_clean_int to x_int
-	}
-	return tuple<vector<int>,vector<int>>(x_int,y_int);
-}
-
-// Returns the pairs in strict ordering
-vector <tuple<int,int>> MakePairs(vector<int> &x,vector<int> &y) {
-	vector <tuple<int,int> > retPairs;
-	assert(x.size() == y.size());
-	for(int i = 0 ; i < x.size(); i++) {
-		if(x[i] < 0 || y[i] < 0) { continue; }
-		retPairs.push_back(tuple<int,int>(x[i],y[i]));
+	if(memoryBudget > 0) {
+		cout.flush();
+		cerr << "#Peak resident memory " << fixed << setprecision(1) << PeakResidentBytes() / 1048576.0 << " MB of the " << memoryBudget / 1048576.0 << " MB budget\n";
 	}
-	return retPairs;
-}
-
-// Simply count the number where the tuples match
-int CountTP(vector <tuple<int,int> > &x) {
-	int count = 0;
-	for(auto &p : x) { if(get<0>(p) == get<1>(p)) { count++; } }
-	return count;
-}
-
-string RemoveGaps(string &seq) {
-	stringstream retSeq;
-	for(int i = 0 ; i < seq.size(); i++) {
-		if(!IsGap(seq[i])) {
-			retSeq << seq[i];
+	if(profiling) {
+		cout.flush();
+		if(profileFile.empty()) { WriteProfile(cerr, alphabet); }
+		else {
+			ofstream out(profileFile.c_str());
+			if(!out.good()) { cerr << "Error opening '"<< profileFile <<"' for the profile." << endl; return -1; }
+			WriteProfile(out, alphabet);
 		}
 	}
-	return retSeq.str();
+	return status;
 }
@@ -0,0 +1,97 @@
+/*
+ * Metrics.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Sum-of-pairs, total column, modeler and per-column agreement scores from one pass over the alignment store
+ */
+
+#include "Metrics.h"
+#include "Profile.h"
+#include <iomanip>
+
+using namespace::std;
+
+unsigned ParseMetrics(const string &list) {
+	unsigned retMetrics = 0;
+	stringstream names(list);
+	string name;
+	while(getline(names, name, ',')) {
+		if(name == "sp") { retMetrics |= SPMetric; }
+		else if(name == "tc") { retMetrics |= TCMetric; }
+		else if(name == "modeler") { retMetrics |= ModelerMetric; }
+		else if(name == "columns") { retMetrics |= ColumnMetric; }
+		else if(name == "all") { retMetrics |= AllMetrics; }
+		else { return 0; }
+	}
+	return retMetrics;
+}
+
+// The counting is that of ScoreColumns (CColumnTally), with the count of each label in each test column of a block also
+// added to its reference column's TP. Once a block is counted, each (test column, label) it touched is checked for holding
+// the whole of its reference column and nothing else
+SMetrics ScoreMetrics(const CAlignStore &store) {
+	CPhaseTimer timer(ColumnPhase);
+	SMetrics retMetrics;
+	SScore &score = retMetrics.score;
+	int refLen = store.RefLength(), testLen = store.TestLength();
+	vector <int> &columnChars = retMetrics.columnChars;
+	vector <long long> &columnTP = retMetrics.columnTP;
+	columnChars.assign(refLen, 0);
+	columnTP.assign(refLen, 0);
+	for(int i = 0; i < store.Size(); i++) {
+		const uint64_t *mask = store.RefMask(i);
+		for(int w = 0; w < store.RefWords(); w++) {
+			for(uint64_t bits = mask[w]; bits; bits &= bits - 1) { score.totalRef += columnChars[(w * 64) + __builtin_ctzll(bits)]++; }
+		}
+	}
+	vector <int> testChars(testLen, 0);		// Characters of reference columns in each test column
+	for(int c = 0; c < testLen; c++) {
+		const uint64_t *mask = store.ColumnMask(c);
+		for(int w = 0; w < store.SeqWords(); w++) { testChars[c] += __builtin_popcountll(mask[w]); }
+		score.totalTest += ((long long)testChars[c] * (testChars[c] - 1)) / 2;
+	}
+	CColumnTally tally(store);
+	vector <pair <int, int> > touched;	// The (test column, label)s of the block
+	for(int start = 0; start < testLen; start += CColumnTally::blockSize) {
+		touched.clear();
+		score.TP += tally.Block(start, my_min(start + CColumnTally::blockSize, testLen), [&](int i, int label, long long before) {
+			if(before == 0) { touched.push_back(make_pair(i, label)); }
+			columnTP[label - 1] += before;
+		});
+		for(auto &t : touched) {
+			long long count = tally.Count(t.first, t.second);
+			int column = t.second - 1;
+			if(columnChars[column] >= 2 && count == columnChars[column] && count == testChars[t.first]) { retMetrics.correctColumns++; }
+		}
+	}
+	for(int c : columnChars) {
+		if(c >= 2) { retMetrics.refColumns++; }
+	}
+	score.FN = score.totalRef - score.TP;
+	score.FP = score.totalTest - score.TP;
+	assert(score.FN >= 0);
+	return retMetrics;
+}
+
+void WriteMetrics(ostream &out, const SMetrics &metrics, unsigned which) {
+	int width = 15;
+	WriteScore(out, metrics.score);
+	if(which & (SPMetric | TCMetric | ModelerMetric)) {
+		out << left << setw(width) << "#Metric" << "Value";
+		if(which & SPMetric) { out << "\n" << setw(width) << "SP" << metrics.SP(); }
+		if(which & TCMetric) { out << "\n" << setw(width) << "TC" << metrics.TC() << " (" << metrics.correctColumns << " of " << metrics.refColumns << " columns)"; }
+		if(which & ModelerMetric) { out << "\n" << setw(width) << "Modeler" << metrics.Modeler(); }
+		out << "\n";
+	}
+	if(which & ColumnMetric) {
+		out << left << setw(width) << "#RefColumn" << setw(width) << "Characters" << setw(width) << "Pairs" << setw(width) << "AlignedPairs" << "Agreement";
+		for(size_t c = 0; c < metrics.columnChars.size(); c++) {
+			long long chars = metrics.columnChars[c], pairs = chars * (chars - 1) / 2;
+			out << "\n" << setw(width) << c + 1 << setw(width) << chars << setw(width) << pairs << setw(width) << metrics.columnTP[c];
+			if(pairs > 0) { out << (double)metrics.columnTP[c] / pairs; }
+			else { out << "-"; }
+		}
+		out << "\n";
+	}
+}
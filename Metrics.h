@@ -0,0 +1,42 @@
+/*
+ * Metrics.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Sum-of-pairs, total column, modeler and per-column agreement scores from one pass over the alignment store
+ *	---
+ *	Every score here follows from how many characters of each reference column land in each test column, which is what
+ *	the column engine already tallies from the labels (see ScoreColumns), so they are all gathered in the same traversal:
+ *		SP        TruePos / totalRef, the fraction of reference pairs the test aligns
+ *		Modeler   TruePos / (TruePos + FalsePos), the fraction of the test's pairs of reference characters that are right
+ *		TC        the fraction of reference columns (those with at least two characters) that the test aligns exactly: all
+ *		          their characters in one test column, which holds no other reference characters
+ *		Columns   for each reference column, its pairs and how many of them the test aligns
+ *	Characters outside the reference fragment of their row play no part, as in the pair scores.
+ */
+
+#ifndef METRICS_H_
+#define METRICS_H_
+#include "Scorer.h"
+#include <ostream>
+#include <vector>
+
+enum EMetric { SPMetric = 1, TCMetric = 2, ModelerMetric = 4, ColumnMetric = 8, AllMetrics = 15 };
+unsigned ParseMetrics(const std::string &list);		// A comma separated list of sp, tc, modeler, columns and all; 0 if any is unknown
+
+struct SMetrics {
+	SScore score;						// The sum-of-pairs totals, equal to ScorePairs
+	long long refColumns = 0;			// Reference columns with at least two characters
+	long long correctColumns = 0;		// Those aligned exactly by the test
+	std::vector <int> columnChars;		// For each reference column: its characters,
+	std::vector <long long> columnTP;	// and the pairs of them the test aligns
+	double SP() const { return score.totalRef > 0 ? (double)score.TP / score.totalRef : 0; }
+	double Modeler() const { return score.totalTest > 0 ? (double)score.TP / score.totalTest : 0; }
+	double TC() const { return refColumns > 0 ? (double)correctColumns / refColumns : 0; }
+};
+
+SMetrics ScoreMetrics(const CAlignStore &store);
+// The metrics asked for, after the usual totals: a #Metric/Value table, then with ColumnMetric one row per reference column
+void WriteMetrics(std::ostream &out, const SMetrics &metrics, unsigned which);
+
+#endif /* METRICS_H_ */
@@ -0,0 +1,95 @@
+/*
+ * PairFile.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Binary file of the score of every pair of sequences, written by -pairs as the pairs are compared
+ */
+
+#include "PairFile.h"
+#include "Sequence.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace::std;
+
+static_assert(sizeof(SPairRecord) == 16, "pair records are 16 bytes on disk");
+
+CPairWriter::CPairWriter(const string &file, const vector <string> &names) : _file(file), _n(names.size()) {
+	string header = PAIRFILE_MAGIC;
+	uint32_t word[2] = { (uint32_t)_n, 0 };
+	uint64_t offset = 0;
+	header.append((const char *)word, sizeof(word));
+	header.append((const char *)&offset, sizeof(offset));
+	for(auto &name : names) {
+		uint32_t length = name.size();
+		header.append((const char *)&length, sizeof(length));
+		header.append(name);
+	}
+	_dataOffset = (header.size() + 15) / 16 * 16;
+	header.resize(_dataOffset, '\0');
+	memcpy(&header[16], &_dataOffset, sizeof(_dataOffset));
+	_fd = open(file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if(_fd < 0) { throw CError("Error opening '" + file + "' for the pair scores.\n"); }
+	off_t size = _dataOffset + PairRecords(_n) * sizeof(SPairRecord);
+	if(pwrite(_fd, header.data(), header.size(), 0) != (ssize_t)header.size() || ftruncate(_fd, size) != 0) {
+		close(_fd);
+		throw CError("Error writing '" + file + "': " + strerror(errno) + "\n");
+	}
+}
+
+CPairWriter::~CPairWriter() {
+	if(_fd >= 0) { close(_fd); }
+}
+
+void CPairWriter::Write(int i, int j0, const SPairRecord *records, int count) const {
+	assert(i < j0 && j0 + count <= _n);
+	size_t bytes = count * sizeof(SPairRecord);
+	if(pwrite(_fd, records, bytes, _dataOffset + PairIndex(i, j0, _n) * sizeof(SPairRecord)) != (ssize_t)bytes) {
+		throw CError("Error writing '" + _file + "': " + strerror(errno) + "\n");
+	}
+}
+
+CPairReader::CPairReader(const string &file) : _buffer(file) {
+	const char *data = _buffer.Data();
+	size_t size = _buffer.Size(), pos = 24;
+	uint32_t n;
+	uint64_t dataOffset;
+	if(size < pos || memcmp(data, PAIRFILE_MAGIC, 8) != 0) { throw CError("\nError: " + file + " is not a pair score file\n"); }
+	memcpy(&n, data + 8, sizeof(n));
+	memcpy(&dataOffset, data + 16, sizeof(dataOffset));
+	for(uint32_t i = 0; i < n; i++) {
+		uint32_t length;
+		if(pos + sizeof(length) > size) { break; }
+		memcpy(&length, data + pos, sizeof(length));
+		pos += sizeof(length);
+		if(pos + length > size) { break; }
+		_names.push_back(string(data + pos, length));
+		pos += length;
+	}
+	if(_names.size() != n || pos > dataOffset || dataOffset % 16 != 0 || size < dataOffset + PairRecords(n) * sizeof(SPairRecord)) {
+		throw CError("\nError: " + file + " is truncated or corrupt\n");
+	}
+	_records = (const SPairRecord *)(data + dataOffset);
+}
+
+int CPairReader::Find(const string &name) const {
+	for(int i = 0; i < Size(); i++) {
+		if(_names[i] == name) { return i; }
+	}
+	return -1;
+}
+
+const SPairRecord &CPairReader::Pair(int i, int j) const {
+	assert(i != j);
+	if(i > j) { swap(i, j); }
+	return _records[PairIndex(i, j, Size())];
+}
+
+void CPairReader::Row(int i, vector <SPairRecord> &row) const {
+	row.assign(Size(), SPairRecord());
+	for(int j = 0; j < i; j++) { row[j] = _records[PairIndex(j, i, Size())]; }
+	if(i + 1 < Size()) { copy(_records + PairIndex(i, i + 1, Size()), _records + PairIndex(i, Size() - 1, Size()) + 1, row.begin() + i + 1); }
+}
@@ -0,0 +1,69 @@
+/*
+ * PairFile.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Binary file of the score of every pair of sequences, written by -pairs as the pairs are compared
+ *	---
+ *	Layout (native byte order):
+ *		"MSAPAIR1"                   8 byte magic
+ *		uint32 N, uint32 0           number of sequences
+ *		uint64 dataOffset            where the records start, a multiple of 16
+ *		N names                      each as uint32 length then the characters, zero padded up to dataOffset
+ *		records                      one SPairRecord per pair i < j, row by row: (0,1) (0,2) .. (0,N-1) (1,2) ..
+ *	Every record is at a fixed offset (PairIndex), so writers put each tile's records straight in place with pwrite and
+ *	readers map the file and look up any pair or row without reading the rest.
+ */
+
+#ifndef PAIRFILE_H_
+#define PAIRFILE_H_
+#include "FileBuffer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define PAIRFILE_MAGIC "MSAPAIR1"
+
+struct SPairRecord {
+	uint32_t TP = 0;
+	uint32_t FP = 0;
+	uint32_t FN = 0;
+	uint32_t totalRef = 0;
+};
+
+// Position of pair (i,j), i < j, among the n(n-1)/2 records
+inline long long PairIndex(int i, int j, int n) { return (long long)i * (2LL * n - i - 1) / 2 + (j - i - 1); }
+inline long long PairRecords(int n) { return (long long)n * (n - 1) / 2; }
+
+// Creates the file and writes its header. Write may be called from several threads at once; each call is one pwrite.
+// Problems are thrown as CError
+class CPairWriter {
+public:
+	CPairWriter(const std::string &file, const std::vector <std::string> &names);
+	~CPairWriter();
+	void Write(int i, int j0, const SPairRecord *records, int count) const;	// The records of pairs (i,j0) .. (i,j0+count-1)
+private:
+	CPairWriter(const CPairWriter &) = delete;
+	CPairWriter &operator=(const CPairWriter &) = delete;
+	std::string _file;
+	int _fd = -1;
+	int _n = 0;
+	uint64_t _dataOffset = 0;
+};
+
+// Maps a file written by CPairWriter and checks its header; only the pages holding the pairs asked for are read
+class CPairReader {
+public:
+	CPairReader(const std::string &file);
+	int Size() const { return _names.size(); }
+	const std::string &Name(int i) const { return _names[i]; }
+	int Find(const std::string &name) const;				// Index of the sequence, or -1
+	const SPairRecord &Pair(int i, int j) const;			// i != j, in either order
+	void Row(int i, std::vector <SPairRecord> &row) const;	// The pairs of sequence i with every other sequence; row[i] is zero
+private:
+	CFileBuffer _buffer;
+	std::vector <std::string> _names;
+	const SPairRecord *_records = nullptr;
+};
+
+#endif /* PAIRFILE_H_ */
@@ -0,0 +1,130 @@
+/*
+ * Parallel.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Tiling of the pair triangle and a small work-stealing scheduler for running the tiles on several threads
+ */
+
+#include "Parallel.h"
+#include "Sequence.h"
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+using namespace::std;
+
+long long STile::Pairs() const {
+	long long count = 0;
+	for(int i = i0; i < i1; i++) { count += my_max(0, j1 - my_max(j0, i + 1)); }
+	return count;
+}
+
+// Tiles are square blocks of tileSize, only those on or above the diagonal are kept
+vector <STile> MakeTiles(int n, int tileSize) {
+	vector <STile> tiles;
+	assert(tileSize > 0);
+	for(int i = 0; i < n; i += tileSize) {
+		for(int j = i; j < n; j += tileSize) {
+			STile t = { i, my_min(i + tileSize, n), j, my_min(j + tileSize, n) };
+			if(t.Pairs() > 0) { tiles.push_back(t); }
+		}
+	}
+	return tiles;
+}
+
+// Each tile goes to the shard holding the middle of its pairs when the pairs are counted out in tile order. This is worked out
+// in exact integers, so processes on machines with different floating point agree on it
+vector <STile> ShardTiles(int n, int tileSize, int shard, int shards) {
+	assert(shard >= 0 && shard < shards);
+	vector <STile> tiles = MakeTiles(n, tileSize), retTiles;
+	long long total = 0, before = 0;
+	for(auto &t : tiles) { total += t.Pairs(); }
+	for(auto &t : tiles) {
+		long long pairs = t.Pairs();
+		int owner = my_min(shards - 1, (int)((unsigned __int128)(2 * before + pairs) * shards / (2 * (unsigned __int128)total)));
+		if(owner == shard) { retTiles.push_back(t); }
+		before += pairs;
+	}
+	return retTiles;
+}
+
+// Catches an exception thrown by work on one of the threads so it can be rethrown on the calling thread once they have all
+// finished. Only the first is kept
+class CFirstError {
+public:
+	bool Run(const function<void()> &work) {
+		try { work(); return true; }
+		catch(...) {
+			lock_guard<mutex> guard(_lock);
+			if(!_error) { _error = current_exception(); }
+			_failed = true;
+			return false;
+		}
+	}
+	bool Failed() const { return _failed; }
+	void Rethrow() { if(_error) { rethrow_exception(_error); } }
+private:
+	mutex _lock;
+	exception_ptr _error;
+	atomic <bool> _failed { false };
+};
+
+int ThreadCount(int requested) {
+	if(requested > 0) { return requested; }
+	int cores = thread::hardware_concurrency();
+	return cores > 0 ? cores : 1;
+}
+
+// Each worker has a deque of tile indices. The owner takes from the front and thieves from the back.
+// Tiles never create new work, so a worker that finds every deque empty is done
+void RunTiles(const vector <STile> &tiles, int threads, const function<void(const STile &, int)> &work) {
+	threads = my_max(1, my_min(threads, (int)tiles.size()));
+	if(threads == 1) {
+		for(auto &t : tiles) { work(t, 0); }
+		return;
+	}
+	struct SQueue { mutex lock; deque <int> tiles; };
+	vector <SQueue> queues(threads);
+	for(int w = 0; w < threads; w++) {
+		int start = (tiles.size() * w) / threads, end = (tiles.size() * (w + 1)) / threads;
+		for(int t = start; t < end; t++) { queues[w].tiles.push_back(t); }
+	}
+	CFirstError error;
+	auto worker = [&](int w) {
+		while(!error.Failed()) {
+			int next = -1;
+			{	lock_guard<mutex> guard(queues[w].lock);
+				if(!queues[w].tiles.empty()) { next = queues[w].tiles.front(); queues[w].tiles.pop_front(); }
+			}
+			for(int v = 1; next < 0 && v < threads; v++) {
+				SQueue &victim = queues[(w + v) % threads];
+				lock_guard<mutex> guard(victim.lock);
+				if(!victim.tiles.empty()) { next = victim.tiles.back(); victim.tiles.pop_back(); }
+			}
+			if(next < 0) { return; }
+			error.Run([&]() { work(tiles[next], w); });
+		}
+	};
+	vector <thread> pool;
+	for(int w = 1; w < threads; w++) { pool.push_back(thread(worker, w)); }
+	worker(0);
+	for(auto &t : pool) { t.join(); }
+	error.Rethrow();
+}
+
+void ParallelFor(int n, int threads, const function<void(int)> &work) {
+	threads = my_max(1, my_min(threads, n));
+	atomic <int> next(0);
+	CFirstError error;
+	auto worker = [&]() {
+		for(int k = next++; k < n && !error.Failed(); k = next++) { error.Run([&]() { work(k); }); }
+	};
+	vector <thread> pool;
+	for(int w = 1; w < threads; w++) { pool.push_back(thread(worker)); }
+	worker();
+	for(auto &t : pool) { t.join(); }
+	error.Rethrow();
+}
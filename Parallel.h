@@ -0,0 +1,34 @@
+/*
+ * Parallel.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Tiling of the pair triangle and a small work-stealing scheduler for running the tiles on several threads
+ */
+
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+#include <functional>
+#include <vector>
+
+// A tile of the upper triangle of pairs: rows [i0,i1) against columns [j0,j1), only pairs with j > i are used
+struct STile {
+	int i0, i1;
+	int j0, j1;
+	long long Pairs() const;			// Number of pairs (i,j) with j > i in the tile
+};
+std::vector <STile> MakeTiles(int n, int tileSize);	// Covers every pair i < j of n items exactly once
+// Shard shard (0 based) of shards of the tiles from MakeTiles: a contiguous run of them holding about 1/shards of the pairs.
+// The shards together cover every tile exactly once, and depend only on n, tileSize and shards
+std::vector <STile> ShardTiles(int n, int tileSize, int shard, int shards);
+
+int ThreadCount(int requested);		// Resolves the -t option; 0 means all available cores
+// Runs work(tile, worker) for each tile on the given number of threads. Each worker starts with its own contiguous share of the
+// tiles and steals from the back of the others when it runs out, so uneven tiles do not leave threads idle
+void RunTiles(const std::vector <STile> &tiles, int threads, const std::function<void(const STile &, int)> &work);
+
+// Runs work(k) for k = 0..n-1 on the given number of threads, handing out the next k to whichever thread is free
+void ParallelFor(int n, int threads, const std::function<void(int)> &work);
+// In both, an exception thrown by work stops any work not yet started and is rethrown to the caller
+
+#endif /* PARALLEL_H_ */
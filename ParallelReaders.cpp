@@ -0,0 +1,223 @@
+/*
+ * ParallelReaders.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Parallel versions of the FASTA, Phylip and Interleaved readers for large inputs
+ *	---
+ *	FASTA records are independent, so the file is split at '>' lines and the chunks are scanned on separate threads.
+ *	Phylip and Interleaved records can only be found by walking the file from the start, so it is done in three steps:
+ *	the lines are indexed in parallel (where each starts, whether the readers would skip it, and how many characters it
+ *	holds once white space is removed); the record structure is then walked serially over that index, which never touches
+ *	the characters themselves; and finally the sequences are built in parallel. Anything the fast path does not expect sends
+ *	the file to the serial reader so that errors are reported exactly as before.
+ */
+
+#include "Sequence.h"
+#include "FileBuffer.h"
+#include "Parallel.h"
+#include <cstdint>
+#include <cstring>
+
+using namespace::std;
+
+static inline bool IsSpaceChar(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f'; }
+
+// Chunk boundaries for a buffer: at most threads chunks of at least chunkBytes, each starting just after a newline for
+// which startsRecord() holds (or at the beginning of the buffer)
+static vector <size_t> ChunkBounds(const char *data, size_t size, int threads, size_t chunkBytes, const function<bool(size_t)> &startsRecord) {
+	int chunks = my_max(1, my_min((size_t)threads, size / my_max(chunkBytes, (size_t)1)));
+	vector <size_t> bounds(1, 0);
+	for(int k = 1; k < chunks; k++) {
+		size_t pos = my_max(bounds.back(), (size * k) / chunks);
+		while(pos < size) {
+			const char *nl = (const char *)memchr(data + pos, '\n', size - pos);
+			if(nl == nullptr) { pos = size; break; }
+			pos = (nl - data) + 1;
+			if(pos < size && startsRecord(pos)) { break; }
+		}
+		if(pos >= size) { break; }
+		bounds.push_back(pos);
+	}
+	bounds.push_back(size);
+	return bounds;
+}
+
+// The serial reader, used when a file is irregular
+static std::vector <CSequence> *SerialReader(std::vector <CSequence> *(*reader)(std::istream &, const std::string &), const CFileBuffer &input, const std::string &SeqFile) {
+	CBufferStream stream(input.Data(), input.Size());
+	return reader(stream, SeqFile);
+}
+
+std::vector <CSequence> *ParallelFASTAReader(const CFileBuffer &input, int threads, size_t chunkBytes) {
+	const char *data = input.Data();
+	vector <size_t> bounds = ChunkBounds(data, input.Size(), threads, chunkBytes, [&](size_t pos) { return data[pos] == '>'; });
+	int chunks = bounds.size() - 1;
+	vector <vector <CSequence> > parts(chunks);
+	ParallelFor(chunks, threads, [&](int k) {
+		ScanFASTA(data + bounds[k], data + bounds[k + 1], [&](SFASTARecord &r) {
+			parts[k].push_back(CSequence(r.TakeName(),r.TakeSeq()));
+		}, k == chunks - 1);
+	});
+	std::vector <CSequence> *RetSeq = new std::vector<CSequence>();
+	for(auto &p : parts) { for(auto &s : p) { RetSeq->push_back(std::move(s)); } }
+	return RetSeq;
+}
+
+// Index of the lines in a buffer, following getline: a final line without a newline still counts
+struct SLineIndex {
+	const char *data = nullptr;
+	vector <size_t> start;			// Offset of each line, plus a sentinel so line i ends (before its newline) at start[i+1]-1
+	vector <uint32_t> chars;		// Number of characters in each line that are not white space
+	vector <char> skip;				// Whether the readers skip the line between records: empty or starting with '#'
+	size_t Lines() const { return chars.size(); }
+	const char *Begin(size_t i) const { return data + start[i]; }
+	const char *End(size_t i) const { return data + start[i + 1] - 1; }
+};
+
+static void IndexLines(const char *data, size_t size, int threads, size_t chunkBytes, SLineIndex &index) {
+	vector <size_t> bounds = ChunkBounds(data, size, threads, chunkBytes, [](size_t) { return true; });
+	int chunks = bounds.size() - 1;
+	// Count the lines starting in each chunk so every chunk can fill its own part of the index
+	vector <size_t> first(chunks + 1, 0);
+	ParallelFor(chunks, threads, [&](int k) {
+		size_t count = 0;
+		for(const char *p = data + bounds[k], *end = data + bounds[k + 1]; p < end; count++) {
+			const char *nl = (const char *)memchr(p, '\n', end - p);
+			p = nl == nullptr ? end : nl + 1;
+		}
+		first[k + 1] = count;
+	});
+	for(int k = 0; k < chunks; k++) { first[k + 1] += first[k]; }
+	index.data = data;
+	index.start.assign(first[chunks] + 1, 0);
+	index.chars.assign(first[chunks], 0);
+	index.skip.assign(first[chunks], 0);
+	ParallelFor(chunks, threads, [&](int k) {
+		size_t line = first[k];
+		for(const char *p = data + bounds[k], *end = data + bounds[k + 1]; p < end; line++) {
+			const char *nl = (const char *)memchr(p, '\n', end - p);
+			const char *lineEnd = nl == nullptr ? end : nl;
+			uint32_t count = 0;
+			for(const char *c = p; c < lineEnd; c++) { count += !IsSpaceChar(*c); }
+			index.start[line] = p - data;
+			index.chars[line] = count;
+			index.skip[line] = (lineEnd == p || *p == '#');
+			p = lineEnd + 1;
+		}
+	});
+	// The sentinel: one past the newline ending the last line, or where that newline would be
+	index.start.back() = first[chunks] == 0 ? 0 : (data[size - 1] == '\n' ? size : size + 1);
+}
+
+// The line giving the number of sequences and their length. Returns false if it is missing or unusual, leaving it to the serial reader to complain
+static bool ReadHeader(const SLineIndex &index, size_t &line, int &noSeq, int &length) {
+	for(line = 0; line < index.Lines() && index.skip[line]; line++) { }
+	if(line == index.Lines()) { return false; }
+	vector <string> Toks = Tokenise(string(index.Begin(line), index.End(line)));
+	if(Toks.size() != 2) { return false; }
+	noSeq = atoi(Toks[0].c_str());
+	length = atoi(Toks[1].c_str());
+	line++;
+	return noSeq > 0 && length > 0;
+}
+
+// Appends [b,e) to seq with white space removed
+static void AppendStripped(string &seq, const char *b, const char *e) {
+	while(b < e) {
+		const char *run = b;
+		while(b < e && !IsSpaceChar(*b)) { b++; }
+		seq.append(run, b - run);
+		while(b < e && IsSpaceChar(*b)) { b++; }
+	}
+}
+
+// Matches the checks and construction at the end of the serial readers
+static std::vector <CSequence> *MakeSequences(vector <string> &Names, vector <string> &Seqs) {
+	vector <CSequence> *RetSeq = new std::vector<CSequence>();
+	size_t length = Seqs[0].size();
+	for(size_t i = 0 ; i < Names.size(); i++) {
+		if(Seqs[i].size() != length) {
+			delete RetSeq;
+			throw CError("\nERROR: Some sequences seem of different lengths?\n");
+		}
+		RetSeq->push_back(CSequence(RemoveWhiteSpace(Names[i]),std::move(Seqs[i])));
+	}
+	return RetSeq;
+}
+
+// Phylip: after the header, blocks of noSeq lines each start at the next line that isn't skipped. The first token of a
+// line in the first block names the sequence, and a line in a later block starting with that name has it removed
+std::vector <CSequence> *ParallelPhylipReader(const CFileBuffer &input, const std::string &SeqFile, int threads, size_t chunkBytes) {
+	SLineIndex index;
+	IndexLines(input.Data(), input.Size(), threads, chunkBytes, index);
+	size_t line;
+	int noSeq, length;
+	if(!ReadHeader(index, line, noSeq, length)) { return SerialReader(PhylipReader, input, SeqFile); }
+	vector <size_t> blockLines;			// Line of row i in block b is blockLines[b * noSeq + i]
+	while(line < index.Lines()) {
+		if(index.skip[line]) { line++; continue; }
+		for(int i = 0; i < noSeq; i++, line++) {
+			if(line >= index.Lines()) { break; }
+			if(index.chars[line] == 0) { return SerialReader(PhylipReader, input, SeqFile); }	// An unexpected line between sequences
+			blockLines.push_back(line);
+		}
+	}
+	vector <string> Names(noSeq), Seqs(noSeq);
+	for(int i = 0; i < noSeq && i < (int)blockLines.size(); i++) {
+		const char *b = index.Begin(blockLines[i]), *e = index.End(blockLines[i]);
+		while(IsSpaceChar(*b)) { b++; }
+		const char *t = b;
+		while(t < e && !IsSpaceChar(*t)) { t++; }
+		Names[i].assign(b, t);
+	}
+	ParallelFor(noSeq, threads, [&](int i) {
+		Seqs[i].reserve(length);
+		for(size_t k = i; k < blockLines.size(); k += noSeq) {
+			const char *b = index.Begin(blockLines[k]), *e = index.End(blockLines[k]);
+			while(IsSpaceChar(*b)) { b++; }
+			const char *t = b;
+			while(t < e && !IsSpaceChar(*t)) { t++; }
+			if(Names[i].compare(0, string::npos, b, t - b) == 0) { b = t; }
+			AppendStripped(Seqs[i], b, e);
+		}
+	});
+	return MakeSequences(Names, Seqs);
+}
+
+// Interleaved: each record is the next line that isn't skipped, giving the name, followed by the lines (again ignoring
+// skipped ones) up to the one that brings the sequence to at least length characters
+std::vector <CSequence> *ParallelInterleavedReader(const CFileBuffer &input, const std::string &SeqFile, int threads, size_t chunkBytes) {
+	SLineIndex index;
+	IndexLines(input.Data(), input.Size(), threads, chunkBytes, index);
+	size_t line;
+	int noSeq, length;
+	if(!ReadHeader(index, line, noSeq, length)) { return SerialReader(InterleavedReader, input, SeqFile); }
+	struct SRecord { size_t name, first, last; bool found = false; };	// Lines of the name and [first,last) of the sequence
+	vector <SRecord> records(noSeq);
+	for(int i = 0; i < noSeq; i++) {
+		while(line < index.Lines() && index.skip[line]) { line++; }
+		if(line >= index.Lines()) { break; }
+		records[i].found = true;
+		records[i].name = line++;
+		records[i].first = line;
+		size_t chars = 0;
+		while(line < index.Lines()) {
+			if(index.skip[line]) { line++; continue; }
+			chars += index.chars[line++];
+			if(chars >= (size_t)length) { break; }
+		}
+		records[i].last = line;
+	}
+	vector <string> Names(noSeq), Seqs(noSeq);
+	ParallelFor(noSeq, threads, [&](int i) {
+		SRecord &r = records[i];
+		if(!r.found) { return; }
+		Names[i].assign(index.Begin(r.name), index.End(r.name));
+		Seqs[i].reserve(length);
+		for(size_t l = r.first; l < r.last; l++) {
+			if(!index.skip[l]) { AppendStripped(Seqs[i], index.Begin(l), index.End(l)); }
+		}
+	});
+	return MakeSequences(Names, Seqs);
+}
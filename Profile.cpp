@@ -0,0 +1,73 @@
+/*
+ * Profile.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Phase timers and counters reported by -profile
+ */
+
+#include "Profile.h"
+#include "Alphabet.h"
+#include "Sequence.h"
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace::std;
+
+bool profiling = false;
+atomic <long long> phaseNanoseconds[nPhases];
+atomic <long long> counters[nCounters];
+thread_local long long threadAllocations = 0;
+
+static chrono::steady_clock::time_point profileStart;
+static const char *phaseNames[nPhases] = { "sniff", "read", "match", "check", "map", "pairs", "columns" };
+static const char *counterNames[nCounters] = { "sequences", "residues", "pairs", "bytes_read", "allocations", "pair_allocations" };
+
+void StartProfile() {
+	for(auto &t : phaseNanoseconds) { t = 0; }
+	for(auto &c : counters) { c = 0; }
+	profileStart = chrono::steady_clock::now();
+	profiling = true;
+}
+
+// The second field of /proc/self/statm is the resident set in pages
+long long ResidentBytes() {
+	long long pages = 0, resident = 0;
+	FILE *statm = fopen("/proc/self/statm", "r");
+	if(statm == NULL) { return 0; }
+	if(fscanf(statm, "%lld %lld", &pages, &resident) != 2) { resident = 0; }
+	fclose(statm);
+	return resident * sysconf(_SC_PAGESIZE);
+}
+
+long long PeakResidentBytes() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (long long)usage.ru_maxrss * 1024;
+}
+
+static string Megabytes(long long bytes) {
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.1f MB", bytes / 1048576.0);
+	return buffer;
+}
+
+void CheckMemory(long long budget, const string &what, long long bytes) {
+	if(budget <= 0) { return; }
+	long long resident = ResidentBytes();
+	if(resident + bytes > budget) {
+		throw CError("\nError: " + what + " needs " + Megabytes(bytes) + " on top of the " + Megabytes(resident) + " in use, over the memory budget of " + Megabytes(budget) + "\n");
+	}
+}
+
+void WriteProfile(ostream &out, const SAlphabet &alphabet) {
+	double wall = chrono::duration<double>(chrono::steady_clock::now() - profileStart).count();
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	out << "{\n  \"wall_seconds\": " << wall << ",\n  \"phase_seconds\": {";
+	for(int p = 0; p < nPhases; p++) { out << (p ? ", " : " ") << "\"" << phaseNames[p] << "\": " << phaseNanoseconds[p] * 1e-9; }
+	out << " },\n  \"counters\": {";
+	for(int c = 0; c < nCounters; c++) { out << (c ? ", " : " ") << "\"" << counterNames[c] << "\": " << counters[c]; }
+	out << " },\n  \"alphabet\": \"" << AlphabetName(alphabet) << "\",\n  \"peak_rss_kb\": " << usage.ru_maxrss << "\n}\n";
+}
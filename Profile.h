@@ -0,0 +1,58 @@
+/*
+ * Profile.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Phase timers and counters reported by -profile
+ *	---
+ *	Everything is gated on the profiling flag, so with -profile off a timer or a count costs a test of one global bool.
+ *	Phases can run on several threads at once (e.g. batch jobs), in which case their times are summed over the threads.
+ *	The check against the memory budget of -mem-budget lives here too: the large allocations check the budget they are given
+ *	before they are made, so a job that will not fit fails at once with an error saying what did not fit, rather than being
+ *	killed after hours of work.
+ */
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+#include "Alphabet.h"
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+enum EPhase { SniffPhase, ReadPhase, MatchPhase, CheckPhase, MapPhase, PairPhase, ColumnPhase, nPhases };
+enum ECounter { SeqCount, ResidueCount, PairCount, ByteCount, AllocCount, PairAllocCount, nCounters };
+
+extern bool profiling;											// Set by -profile
+extern std::atomic <long long> phaseNanoseconds[nPhases];
+extern std::atomic <long long> counters[nCounters];
+// Calls to operator new on this thread, counted by the operator new of Allocations.cpp in programs that link it, as is the
+// profile's allocations counter, which only counts while profiling
+extern thread_local long long threadAllocations;
+
+void StartProfile();						// Turns profiling on and starts the wall clock
+void WriteProfile(std::ostream &out, const SAlphabet &alphabet);		// The report as JSON, naming the alphabet the inputs were read with
+
+long long ResidentBytes();					// The resident set size now, or 0 where it cannot be read
+long long PeakResidentBytes();				// The most it has been
+// Throws CError if the resident memory plus the bytes about to be allocated for what would go over budget, the bytes the
+// process may use (-mem-budget); a budget of 0 is no limit
+void CheckMemory(long long budget, const std::string &what, long long bytes = 0);
+
+inline void ProfileCount(ECounter counter, long long n) {
+	if(profiling) { counters[counter] += n; }
+}
+
+// Adds the time from its construction to its destruction to a phase
+class CPhaseTimer {
+public:
+	CPhaseTimer(EPhase phase) : _phase(phase) { if(profiling) { _start = std::chrono::steady_clock::now(); } }
+	~CPhaseTimer() {
+		if(profiling) { phaseNanoseconds[_phase] += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count(); }
+	}
+private:
+	EPhase _phase;
+	std::chrono::steady_clock::time_point _start;
+};
+
+#endif /* PROFILE_H_ */
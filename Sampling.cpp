@@ -0,0 +1,133 @@
+/*
+ * Sampling.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Approximate pair scoring from a random sample of the pairs, for alignments too deep to compare every pair
+ */
+
+#include "Sampling.h"
+#include "Kernels.h"
+#include "PairFile.h"
+#include "Parallel.h"
+#include "Profile.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <random>
+
+using namespace::std;
+
+namespace {
+const int maxStrata = 64;
+const long long minDraws = 64;		// Pairs drawn per stratum in the first round, and at least per later round
+const double z95 = 1.959964;
+
+enum { TPSum, FPSum, FNSum, RefSum, nSums };
+
+// The sample drawn so far from one stratum, padded so workers don't share cache lines
+struct SStratum {
+	long long lo = 0, hi = 0;		// Pairs [lo,hi) in PairIndex order
+	mt19937_64 random;
+	long long n = 0;
+	double sum[nSums] = { };
+	double sumSq[nSums] = { };
+	char pad[64];
+};
+}
+
+// The pair (i,j) at position k in PairIndex order, from the positions of the first pair of each row
+static void PairAt(const vector <long long> &rowStart, long long k, int &i, int &j) {
+	i = upper_bound(rowStart.begin(), rowStart.end(), k) - rowStart.begin() - 1;
+	j = i + 1 + (int)(k - rowStart[i]);
+}
+
+// Draws pairs in rounds until the precision is reached, filling in retScore. Returns false, having stopped early, if that would
+// take as many pairs as there are
+static bool DrawSample(const CAlignStore &store, const SSampleOptions &options, SSampledScore &retScore) {
+	CPhaseTimer timer(PairPhase);
+	int n = store.Size();
+	vector <long long> rowStart(my_max(n - 1, 0));
+	for(int i = 0; i + 1 < n; i++) { rowStart[i] = PairIndex(i, i + 1, n); }
+	int strata = (int)my_min((long long)maxStrata, retScore.pairs);
+	vector <SStratum> stratum(strata);
+	for(int h = 0; h < strata; h++) {
+		stratum[h].lo = retScore.pairs * h / strata;
+		stratum[h].hi = retScore.pairs * (h + 1) / strata;
+		seed_seq seed{ (unsigned)(options.seed >> 32), (unsigned)options.seed, (unsigned)h };
+		stratum[h].random.seed(seed);
+	}
+	PairKernel();
+	long long draws = minDraws;
+	while(retScore.sampled + draws * strata < retScore.pairs) {
+		ParallelFor(strata, options.threads, [&](int h) {
+			SStratum &s = stratum[h];
+			uniform_int_distribution <long long> pick(s.lo, s.hi - 1);
+			for(long long d = 0; d < draws; d++) {
+				int i, j;
+				PairAt(rowStart, pick(s.random), i, j);
+				SScore pair = ComparePairs(store, i, j);
+				double value[nSums] = { (double)pair.TP, (double)pair.FP, (double)pair.FN, (double)pair.totalRef };
+				for(int q = 0; q < nSums; q++) { s.sum[q] += value[q]; s.sumSq[q] += value[q] * value[q]; }
+			}
+			s.n += draws;
+		});
+		retScore.sampled += draws * strata;
+		// Stratified estimates of the totals and their variances
+		double total[nSums] = { }, variance[nSums] = { };
+		for(auto &s : stratum) {
+			double size = s.hi - s.lo;
+			for(int q = 0; q < nSums; q++) {
+				double mean = s.sum[q] / s.n;
+				total[q] += size * mean;
+				variance[q] += size * size * my_max(0.0, (s.sumSq[q] - s.sum[q] * mean) / (s.n - 1)) / s.n;
+			}
+		}
+		// The variances fall as 1/n, so the worst total says how many more draws reach the precision; at most doubling each round
+		double target = options.precision * total[RefSum], ratio = 0;
+		for(int q = 0; q < nSums; q++) {
+			double halfWidth = z95 * sqrt(variance[q]);
+			ratio = my_max(ratio, halfWidth <= target ? 0.0 : target > 0 ? (halfWidth / target) * (halfWidth / target) : HUGE_VAL);
+		}
+		if(ratio <= 1) {
+			retScore.score.TP = llround(total[TPSum]);
+			retScore.score.FP = llround(total[FPSum]);
+			retScore.score.FN = llround(total[FNSum]);
+			retScore.score.totalRef = llround(total[RefSum]);
+			retScore.score.totalTest = retScore.score.TP + retScore.score.FP;
+			retScore.halfWidth.TP = ceil(z95 * sqrt(variance[TPSum]));
+			retScore.halfWidth.FP = ceil(z95 * sqrt(variance[FPSum]));
+			retScore.halfWidth.FN = ceil(z95 * sqrt(variance[FNSum]));
+			retScore.halfWidth.totalRef = ceil(z95 * sqrt(variance[RefSum]));
+			retScore.halfWidth.totalTest = ceil(z95 * sqrt(variance[TPSum] + variance[FPSum]));
+			ProfileCount(PairCount, retScore.sampled);
+			return true;
+		}
+		long long more = (long long)my_min(ratio * stratum[0].n, 2.0 * stratum[0].n) - stratum[0].n;
+		draws = my_max(minDraws, more);
+	}
+	ProfileCount(PairCount, retScore.sampled);
+	return false;
+}
+
+SSampledScore SampleScore(const CAlignStore &store, const SSampleOptions &options) {
+	SSampledScore retScore;
+	retScore.pairs = PairRecords(store.Size());
+	if(!(options.precision > 0)) { throw CError("\nError: the sampling precision must be greater than 0\n"); }
+	if(DrawSample(store, options, retScore)) { return retScore; }
+	// Sampling would compare as many pairs as there are, so compare them all
+	retScore.score = ScorePairs(store, options.threads);
+	retScore.halfWidth = SScore();
+	retScore.sampled = retScore.pairs;
+	retScore.exact = true;
+	return retScore;
+}
+
+void WriteSampledScore(ostream &out, const SSampledScore &score, const SSampleOptions &options) {
+	int width = 15;
+	WriteScore(out, score.score);
+	out << left << setw(width) << "#+/-95%" << setw(width) << score.halfWidth.TP << setw(width) << score.halfWidth.FP << setw(width) << score.halfWidth.FN << setw(width) << score.halfWidth.totalRef;
+	out << "\n#Sampled " << score.sampled << " of " << score.pairs << " pairs (seed " << options.seed << ")";
+	if(score.exact) { out << "; every pair was compared, so the score is exact"; }
+	out << "\n";
+}
@@ -0,0 +1,44 @@
+/*
+ * Sampling.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Approximate pair scoring from a random sample of the pairs, for alignments too deep to compare every pair
+ *	---
+ *	The pairs i < j are split into strata of consecutive pairs in PairIndex order, so each stratum holds the pairs of a run of
+ *	reference rows, which tend to be alike. Pairs are drawn uniformly (with replacement) from every stratum in rounds, and each
+ *	total is estimated as the sum over the strata of the stratum size times its sample mean, with the usual stratified
+ *	variance. Sampling stops once the 95% confidence interval of every total is within +/- precision * totalRef, so the rates
+ *	TP/totalRef, FP/totalRef and FN/totalRef are known to within precision; the number of pairs compared grows with
+ *	1/precision^2 and not with the depth of the alignment. If that would take as many pairs as there are, every pair is
+ *	compared instead and the score is exact.
+ *	Each stratum has its own generator seeded from the seed and the stratum, so a seed gives the same result on any number of
+ *	threads.
+ */
+
+#ifndef SAMPLING_H_
+#define SAMPLING_H_
+#include "Scorer.h"
+#include <ostream>
+
+struct SSampleOptions {
+	double precision = 0.001;			// Wanted 95% confidence half-width of each total, as a fraction of totalRef
+	unsigned long long seed = 1;
+	int threads = 1;
+	TWarning warning;					// As in SScoreOptions (Library.h); the gaps are the reference's
+	long long memoryBudget = 0;			// As in SScoreOptions
+};
+
+struct SSampledScore {
+	SScore score;				// The estimated totals, rounded
+	SScore halfWidth;			// Half-widths of their 95% confidence intervals, rounded up; zero when exact
+	long long sampled = 0;		// Pairs compared
+	long long pairs = 0;		// Pairs in the alignment
+	bool exact = false;			// Every pair was compared
+};
+
+SSampledScore SampleScore(const CAlignStore &store, const SSampleOptions &options);
+// The score as WriteScore does, followed by a commented line of the half-widths and one of the pairs sampled
+void WriteSampledScore(std::ostream &out, const SSampledScore &score, const SSampleOptions &options);
+
+#endif /* SAMPLING_H_ */
@@ -0,0 +1,292 @@
+/*
+ * Scorer.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Pair scoring of a test MSA against a reference MSA
+ */
+
+#include "Scorer.h"
+#include "Parallel.h"
+#include "Kernels.h"
+#include "Profile.h"
+#include "PairFile.h"
+#include <iomanip>
+
+using namespace::std;
+
+static SAnchor MapToReference(const string &x, const string &y, const string &y_clean, const vector <int> &y_clean_int, const vector <int> &y_borders, int *x_int, const SAlphabet &alphabet);
+
+// Compare rows i and j of the store
+// ---
+// A reference pair exists in every column where both reference rows have a character, which is the popcount of the two masks ANDed.
+// A test pair exists in every test column where both characters are in the reference and it is a true positive if they share the reference column.
+// Both are counted directly by the vectorised kernels in Kernels.cpp. Test pairs can only be in the columns where the two rows'
+// spans overlap, so the labels are only compared there
+SScore ComparePairs(const CAlignStore &store, int i, int j) {
+	SScore retScore;
+	const SPairKernel &kernel = PairKernel();
+	int first = my_max(store.First(i), store.First(j)), end = my_min(store.End(i), store.End(j));
+	if(first < end) {
+		SLabelCounts counts = kernel.labels(store.Labels(i) + (first - store.First(i)), store.Labels(j) + (first - store.First(j)), end - first);
+		retScore.totalTest = counts.both;
+		retScore.TP = counts.same;
+	}
+	retScore.totalRef = kernel.common(store.RefMask(i), store.RefMask(j), store.RefWords());
+	retScore.FN = retScore.totalRef - retScore.TP;
+	retScore.FP = retScore.totalTest - retScore.TP;
+	assert(retScore.FN >= 0);
+	return retScore;
+}
+
+// Do all against all comparison
+// ---
+// The triangle of pairs is split into tiles run by RunTiles. Each worker accumulates into its own score and the totals are summed
+// in worker order at the end; the sums are exact integers so the result does not depend on the number of threads.
+// The pairs of a tile row are consecutive records of a pair file, so they are collected on the stack and written with one call
+const int tileSize = 32;
+static SScore ScoreTiles(const CAlignStore &store, const vector <STile> &tiles, int threads, long long *allocations, const CPairWriter *pairs) {
+	struct SWorkerScore { SScore score; long long allocations = 0; char pad[64]; };	// Padded so workers don't share cache lines
+	CPhaseTimer timer(PairPhase);
+	long long count = 0;
+	for(auto &t : tiles) { count += t.Pairs(); }
+	ProfileCount(PairCount, count);
+	SScore retScore;
+	threads = my_max(1, my_min(threads, (int)tiles.size()));
+	vector <SWorkerScore> workerScore(threads);
+	PairKernel();		// Chooses the kernel before any pair is compared, so the pairs themselves never allocate
+	RunTiles(tiles, threads, [&](const STile &t, int w) {
+		SScore &score = workerScore[w].score;
+		SPairRecord records[tileSize];
+		long long allocated = threadAllocations;
+		for(int i = t.i0; i < t.i1; i++) {
+			int j0 = my_max(t.j0, i + 1);
+			for(int j = j0; j < t.j1; j++) {
+				SScore pair = ComparePairs(store,i,j);
+				score += pair;
+				if(pairs != nullptr) {
+					SPairRecord &r = records[j - j0];
+					r.TP = pair.TP; r.FP = pair.FP; r.FN = pair.FN; r.totalRef = pair.totalRef;
+				}
+			}
+			if(pairs != nullptr && j0 < t.j1) { pairs->Write(i, j0, records, t.j1 - j0); }
+		}
+		workerScore[w].allocations += threadAllocations - allocated;
+	});
+	long long pairAllocations = 0;
+	for(auto &w : workerScore) { retScore += w.score; pairAllocations += w.allocations; }
+	ProfileCount(PairAllocCount, pairAllocations);
+	if(allocations != nullptr) { *allocations = pairAllocations; }
+	return retScore;
+}
+SScore ScorePairs(const CAlignStore &store, int threads, long long *allocations, const CPairWriter *pairs) {
+	return ScoreTiles(store, MakeTiles(store.Size(), tileSize), threads, allocations, pairs);
+}
+SScore ScorePairShard(const CAlignStore &store, int shard, int shards, int threads) {
+	if(shard < 0 || shard >= shards) { throw CError("\nError: shard " + to_string(shard + 1) + " of " + to_string(shards) + " does not exist\n"); }
+	return ScoreTiles(store, ShardTiles(store.Size(), tileSize, shard, shards), threads, nullptr, nullptr);
+}
+
+// Compute the sum-of-pairs totals from column tallies
+// ---
+// Every pair of characters sharing a reference column is a reference pair, so totalRef sums m(m-1)/2 over the reference columns.
+// Likewise totalTest sums n(n-1)/2 over the test columns, where n is the popcount of the column mask.
+// The true positives in a test column are the pairs mapping to the same reference column, so the characters are grouped by label and
+// each group of size c adds c(c-1)/2. These are accumulated incrementally (a new member adds the current group size) over blocks
+// of test columns, so the label counts only need refLen storage per column in the block and the rows are read sequentially.
+SScore ScoreColumns(const CAlignStore &store) {
+	CPhaseTimer timer(ColumnPhase);
+	SScore retScore;
+	vector <long long> refCount(store.RefLength(),0);
+	for(int i = 0; i < store.Size(); i++) {
+		const uint64_t *mask = store.RefMask(i);
+		for(int w = 0; w < store.RefWords(); w++) {
+			for(uint64_t bits = mask[w]; bits; bits &= bits - 1) { retScore.totalRef += refCount[(w * 64) + __builtin_ctzll(bits)]++; }
+		}
+	}
+	SScore testScore = ScoreTestColumns(store, 0, store.TestLength());
+	retScore.totalTest = testScore.totalTest;
+	retScore.TP = testScore.TP;
+	retScore.FN = retScore.totalRef - retScore.TP;
+	retScore.FP = retScore.totalTest - retScore.TP;
+	assert(retScore.FN >= 0);
+	return retScore;
+}
+
+// The test side of ScoreColumns over test columns [c0,c1)
+SScore ScoreTestColumns(const CAlignStore &store, int c0, int c1) {
+	SScore retScore;
+	for(int c = c0; c < c1; c++) {
+		long long n = 0;
+		const uint64_t *mask = store.ColumnMask(c);
+		for(int w = 0; w < store.SeqWords(); w++) { n += __builtin_popcountll(mask[w]); }
+		retScore.totalTest += (n * (n - 1)) / 2;
+	}
+	CColumnTally tally(store);
+	for(int start = c0; start < c1; start += CColumnTally::blockSize) { retScore.TP += tally.Block(start, my_min(start + CColumnTally::blockSize, c1)); }
+	retScore.FP = retScore.totalTest - retScore.TP;
+	return retScore;
+}
+
+SScore Score(const CAlignStore &store, EEngine engine, int threads, const CPairWriter *pairs) {
+	SScore score;
+	switch(engine) {
+	case Pairs:
+		score = ScorePairs(store, threads, nullptr, pairs); break;
+	case Columns:
+		if(pairs != nullptr) { throw CError("\nError: the column engine cannot write pair scores\n"); }
+		score = ScoreColumns(store); break;
+	case Check: {
+		long long allocations = 0;
+		score = ScorePairs(store, threads, &allocations, pairs);
+		if(!(ScoreColumns(store) == score)) { throw CError("\nError: pair and column engines give different scores\n"); }
+		if(allocations != 0) { throw CError("\nError: the pair comparisons allocated memory " + to_string(allocations) + " times\n"); }
+		break;
+	}
+	}
+	return score;
+}
+
+// Read an alignment. The rows are left in file order, as the test rows are matched to the reference by name in CheckMatched
+vector <CSequence> *ReadAlignment(const string &file, int threads, const SAlphabet &alphabet, const TWarning &warning, long long memoryBudget) {
+	return ReadSequences(file, threads, alphabet, warning, memoryBudget);
+}
+void CheckLengths(vector <CSequence> &data, const string &which) {
+	CPhaseTimer timer(CheckPhase);
+	assert(!data.empty());
+	for(auto & s : data) {
+		if(s.length() != data[0].length()) { throw CError("\nSequences of uneven length in " + which + " MSA file\n"); }
+	}
+}
+// A hash join: each test name is looked up in the reference's index in one pass, then the rows are moved into reference order
+void CheckMatched(vector <CSequence> &test, const CRefIndex &ref) {
+	{	CPhaseTimer timer(MatchPhase);
+		vector <int> refRow(test.size(), -1);
+		vector <bool> found(ref.Size(), false);
+		string extra, repeated, missing;
+		for(size_t i = 0 ; i < test.size(); i++) {
+			int r = ref.Find(test[i].Name());
+			if(r < 0) { extra += " " + test[i].Name(); }
+			else if(found[r]) { repeated += " " + test[i].Name(); }
+			else { found[r] = true; refRow[i] = r; }
+		}
+		for(int r = 0; r < ref.Size(); r++) {
+			if(!found[r]) { missing += " " + ref.Name(r); }
+		}
+		if(!extra.empty() || !repeated.empty() || !missing.empty()) {
+			string message = "\nError: test and reference MSAs have different sequences\n";
+			if(!missing.empty()) { message += "missing from the test:" + missing + "\n"; }
+			if(!extra.empty()) { message += "not in the reference:" + extra + "\n"; }
+			if(!repeated.empty()) { message += "repeated in the test:" + repeated + "\n"; }
+			throw CError(message);
+		}
+		vector <CSequence> ordered(test.size());
+		for(size_t i = 0 ; i < test.size(); i++) { ordered[refRow[i]] = move(test[i]); }
+		test.swap(ordered);
+	}
+	CheckLengths(test, "test");
+	if(ref.Length() > test[0].length()) { throw CError("\nError: reference MSA is long than test MSA\n"); }
+}
+void WriteComparing(ostream &out, const string &testFile, int testSeq, int testLen, const string &refFile, int refSeq, int refLen) {
+	out << "#Comparing " << testFile << " (seq:" << testSeq << ";l=" << testLen;
+	out << ") => REF " << refFile << "(seq:" << refSeq << ";l=" << refLen << ")";
+}
+void WriteScore(ostream &out, const SScore &score) {
+	int width = 15;
+	out << left << "\n" << setw(width)<< "#TruePos"<< setw(width) <<"FalsePos"<< setw(width) <<"FalseNeg"<< setw(width) <<"totalRef";
+	out << "\n" << setw(width) << score.TP << setw(width) << score.FP << setw(width) << score.FN << setw(width) << score.totalRef;
+	out << "\n";
+}
+
+// Compare the pairs x and y <0: test, 1: ref> and return the score
+// ---
+// The totals are those of the pair lists the original MapPositions/MakePairs built, counted directly from the labels.
+// The labels go in per-thread scratch buffers, so once they have grown to the sequence length a comparison allocates nothing
+SScore ComparePairs(const tuple<string, string> &seq1, const tuple<string, string> &seq2, const SAlphabet &alphabet) {
+	static thread_local vector <int> x1_int, x2_int;
+	const string &x1 = get<0>(seq1), &y1 = get<1>(seq1), &x2 = get<0>(seq2), &y2 = get<1>(seq2);
+	assert(x1.size() == x2.size() && y1.size() == y2.size());
+	SScore retScore;
+	ProfileCount(PairCount, 1);
+	// Get labels for each of the test sequences so we can identify and compare homology pairs; Detailed in MapTestLabels
+	x1_int.resize(x1.size());
+	x2_int.resize(x2.size());
+	MapTestLabels(x1, y1, x1_int.data(), alphabet);
+	MapTestLabels(x2, y2, x2_int.data(), alphabet);
+	// Test pairs have both characters present in the reference (both labels >= 0), and are true if they share the reference column
+	for(size_t i = 0; i < x1.size(); i++) {
+		if(x1_int[i] < 0 || x2_int[i] < 0) { continue; }
+		retScore.totalTest++;
+		if(x1_int[i] == x2_int[i]) { retScore.TP++; }
+	}
+	// Reference pairs are the columns where both reference sequences have a character
+	WithAlphabet(alphabet, [&](auto policy) {
+		for(size_t i = 0; i < y1.size(); i++) {
+			if(!policy.IsGap(y1[i]) && !policy.IsGap(y2[i])) { retScore.totalRef++; }
+		}
+	});
+	retScore.FN = retScore.totalRef - retScore.TP;		// FNs are the reference pairs not found
+	retScore.FP = retScore.totalTest - retScore.TP;		// FPs are the test pairs that are not TP
+	assert(retScore.FN >= 0);
+	return retScore;
+}
+
+// Label each character of the test sequence x with the (1-based) reference column it occupies in y, or -BIG_NUMBER if it is a gap or not in y
+vector<int> MapTestLabels(const string &x, const string &y, const SAlphabet &alphabet) {
+	vector <int> x_int(x.size(),-BIG_NUMBER);
+	MapTestLabels(x,y,x_int.data(),alphabet);
+	return x_int;
+}
+SAnchor MapTestLabels(const string &x, const string &y, int *x_int, const SAlphabet &alphabet) {
+	static thread_local string y_clean;						// Scratch, reused by every call on the thread
+	static thread_local vector <int> y_clean_int, y_borders;
+	RemoveGaps(y, y_clean, alphabet);
+	y_clean_int.assign(y_clean.size(),-BIG_NUMBER);			// Storage of character mapping
+	int pos = 0;										// Sequence position number (observable character)
+	WithAlphabet(alphabet, [&](auto policy) {
+		for(int i = 0; i < (int)y.size(); i++) {
+			if(!policy.IsGap(y[i])) { y_clean_int[pos++] = i + 1; }    // Transfer that number to y_clean_int for mapping to x
+		}
+	});
+	AnchorBorders(y_clean, y_borders);
+	return MapToReference(x, y, y_clean, y_clean_int, y_borders, x_int, alphabet);
+}
+SAnchor MapTestLabels(const string &x, const CRefIndex &ref, int row, int *x_int) {
+	return MapToReference(x, ref.Row(row), ref.Residues(row), ref.ResidueColumn(row), ref.Borders(row), x_int, ref.Alphabet());
+}
+// Find the reference residues y_clean in x and give each the column from y_clean_int. The anchor is found in linear time
+// from the failure function y_borders of y_clean, and the first occurrence is used if there are several
+static SAnchor MapToReference(const string &x, const string &y, const string &y_clean, const vector <int> &y_clean_int, const vector <int> &y_borders, int *x_int, const SAlphabet &alphabet) {
+	static thread_local string x_clean;
+	RemoveGaps(x, x_clean, alphabet);	// The raw sequences unaligned
+	SAnchor anchor = FindAnchor(x_clean, y_clean, y_borders);
+	int start_x = anchor.offset;				// Get the real character position that y starts in clean_x
+	int end_x = start_x + y_clean.size();		// Get the positon in clean_x where y is expected to end
+	if(anchor.matches == 0) { throw CError("\nError: reference sequence is not a valid subset of the test sequence\ntest: " + x + "\nref:  " + y); }
+	// Now build the x_int
+	int pos = 0;										// Sequence position number (observable character)
+	WithAlphabet(alphabet, [&](auto policy) {
+		for(size_t i = 0; i < x.size(); i++) {
+			x_int[i] = -BIG_NUMBER;
+			if(policy.IsGap(x[i])) { continue; }		// Don't care about gaps
+			if(pos < start_x || pos >= end_x) { pos++; continue; }	// If the observable character in x is not also in y, just skip
+			x_int[i] = y_clean_int[pos++ - start_x];				// Otherwise add the label from y_clean_int to x_int
+		}
+	});
+	return anchor;
+}
+
+string RemoveGaps(const string &seq, const SAlphabet &alphabet) {
+	string retSeq;
+	RemoveGaps(seq, retSeq, alphabet);
+	return retSeq;
+}
+void RemoveGaps(const string &seq, string &retSeq, const SAlphabet &alphabet) {
+	retSeq.clear();
+	retSeq.reserve(seq.size());
+	WithAlphabet(alphabet, [&](auto policy) {
+		for(char c : seq) {
+			if(!policy.IsGap(c)) { retSeq.push_back(c); }
+		}
+	});
+}
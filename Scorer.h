@@ -0,0 +1,118 @@
+/*
+ * Scorer.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Pair scoring of a test MSA against a reference MSA
+ */
+
+#ifndef SCORER_H_
+#define SCORER_H_
+#include "Sequence.h"
+#include "AlignStore.h"
+#include <tuple>
+
+class CPairWriter;
+
+struct SScore {
+	long long TP = 0;			// Number of true pairs
+	long long FP = 0;
+	long long FN = 0;			// Number of pairs not captured in true alignment
+	long long totalRef = 0;		// Number pairs in reference alignment
+	long long totalTest = 0;	// Total number of pairs in test alignment
+	SScore operator+=(const SScore &S) {
+		TP += S.TP;
+		FP += S.FP;
+		FN += S.FN;
+		totalRef += S.totalRef;
+		totalTest += S.totalTest;
+		return *this;
+	}
+	SScore operator-=(const SScore &S) {
+		TP -= S.TP;
+		FP -= S.FP;
+		FN -= S.FN;
+		totalRef -= S.totalRef;
+		totalTest -= S.totalTest;
+		return *this;
+	}
+	bool operator==(const SScore &S) const {
+		return TP == S.TP && FP == S.FP && FN == S.FN && totalRef == S.totalRef && totalTest == S.totalTest;
+	}
+};
+
+// Scoring from the alignment store
+SScore ComparePairs(const CAlignStore &store, int i, int j);	// Compare rows i and j; identical result to the string version below
+
+// Scoring engines over the whole alignment
+enum EEngine { Pairs, Columns, Check };
+// Sum of ComparePairs over all pairs: O(N^2 L). Gives the heap allocations made while comparing pairs, which should be none,
+// and if pairs is given writes each pair's score to it as the pairs are compared
+SScore ScorePairs(const CAlignStore &store, int threads = 1, long long *allocations = nullptr, const CPairWriter *pairs = nullptr);
+// The part of ScorePairs from shard (0 based) of shards, a deterministic slice of the pairs; the shards sum to ScorePairs
+SScore ScorePairShard(const CAlignStore &store, int shard, int shards, int threads = 1);
+SScore Score(const CAlignStore &store, EEngine engine, int threads, const CPairWriter *pairs = nullptr);	// Runs the chosen engine; Check fails if they disagree or the pairs allocate. Columns cannot write pairs
+SScore ScoreColumns(const CAlignStore &store);					// Same totals from per-column tallies: O(N L)
+SScore ScoreTestColumns(const CAlignStore &store, int c0, int c1);	// TP, FP and totalTest of the pairs in test columns [c0,c1)
+
+// How many characters of each reference column are in each test column, for a block of up to blockSize test columns at a
+// time. The stamps mark which block a count belongs to, so nothing needs resetting between blocks. Shared by the column
+// engine and ScoreMetrics
+class CColumnTally {
+public:
+	static const int blockSize = 64;
+	CColumnTally(const CAlignStore &store) : _store(store), _stride(store.RefLength() + 1), _count(blockSize * _stride, 0), _stamp(blockSize * _stride, -1) { }
+	// Tallies test columns [start,end) and returns the pairs in them that share a reference column. For each character,
+	// hook(column, label, before) is called with the characters of its reference column already counted in its test column
+	template <typename THook> long long Block(int start, int end, THook hook);
+	long long Block(int start, int end) { return Block(start, end, [](int, int, long long) { }); }
+	long long Count(int column, int label) const {	// In the last block tallied
+		int k = ((column - _start) * _stride) + label;
+		return _stamp[k] == _start ? _count[k] : 0;
+	}
+private:
+	const CAlignStore &_store;
+	int _stride, _start = -1;
+	std::vector <long long> _count;
+	std::vector <int> _stamp;
+};
+
+template <typename THook> long long CColumnTally::Block(int start, int end, THook hook) {
+	assert(end - start <= blockSize);
+	long long retPairs = 0;
+	_start = start;
+	for(int s = 0; s < _store.Size(); s++) {
+		const int *labels = _store.Labels(s);
+		int first = _store.First(s), last = my_min(end, _store.End(s));
+		for(int i = my_max(start, first); i < last; i++) {
+			int label = labels[i - first];
+			if(label < 0) { continue; }
+			assert(label > 0 && label < _stride);
+			int k = ((i - start) * _stride) + label;
+			if(_stamp[k] != start) { _stamp[k] = start; _count[k] = 0; }
+			hook(i, label, _count[k]);
+			retPairs += _count[k]++;
+		}
+	}
+	return retPairs;
+}
+
+// Reading, checking and reporting a comparison, shared by the command line and the server. Problems are thrown as CError
+// Sequences in file order; CheckMatched pairs them up
+std::vector <CSequence> *ReadAlignment(const std::string &file, int threads, const SAlphabet &alphabet = SAlphabet(), const TWarning &warning = TWarning(), long long memoryBudget = 0);
+void CheckLengths(std::vector <CSequence> &data, const std::string &which);		// All rows the same length; which is "test" or "reference"
+// Puts the test rows in reference order by name, reporting every name found on only one side, and checks they are of even
+// length and no shorter than the reference
+void CheckMatched(std::vector <CSequence> &test, const CRefIndex &ref);
+void WriteComparing(std::ostream &out, const std::string &testFile, int testSeq, int testLen, const std::string &refFile, int refSeq, int refLen);
+void WriteScore(std::ostream &out, const SScore &score);
+
+// The original string based scoring path. The gaps are those of alphabet; with the store they are the reference index's
+SScore ComparePairs(const std::tuple<std::string, std::string> &s1, const std::tuple<std::string, std::string> &s2, const SAlphabet &alphabet = SAlphabet()); // Compare sequences s1/s2 with <test,ref> for each; no allocation once warmed up
+std::string RemoveGaps(const std::string &seq, const SAlphabet &alphabet = SAlphabet());
+void RemoveGaps(const std::string &seq, std::string &out, const SAlphabet &alphabet = SAlphabet());		// As above, reusing out's storage
+std::vector<int> MapTestLabels(const std::string &x, const std::string &y, const SAlphabet &alphabet = SAlphabet());	// Label each character of x with its column in y (the x half of the original MapPositions)
+SAnchor MapTestLabels(const std::string &x, const std::string &y, int *labels, const SAlphabet &alphabet = SAlphabet());	// As above, writing the x.size() labels into labels
+SAnchor MapTestLabels(const std::string &x, const CRefIndex &ref, int row, int *labels);	// As above, with y as row of the reference index
+
+#endif /* SCORER_H_ */
@@ -6,49 +6,60 @@
  */
 
 #include "Sequence.h"
+#include "FileBuffer.h"
+#include "Gzip.h"
+#include "Profile.h"
 #include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
 
-int CSequence::_maxLength = 0;
 char CSequence::_filterOut = 'X';
 
 using namespace::std;
 
 //////////////// CSequence
 CSequence::CSequence(std::string name, std::string seq) {
-	AddName(name);
-	AddSequence(seq);
-	InitialiseFlags();
+	AddName(std::move(name));
+	AddSequence(std::move(seq));
+}
+CSequence::SFilterFlags &CSequence::Flags() {
+	if(!_flags) {
+		_flags.reset(new SFilterFlags());
+		_flags->Inside.assign(_seq.size(),true);
+		_flags->Remove.assign(_seq.size(),false);
+	}
+	return *_flags;
 }
 void CSequence::AddName(std::string name) {
 	if(!_name.empty()) {
-		std::cout << "\nCSequence ERROR: Trying to added name to non-empty named sequence\n";
-		exit(-1);
+		throw CError("\nCSequence ERROR: Trying to added name to non-empty named sequence\n");
 	}
-	_name = name;
+	_name = std::move(name);
 }
 void CSequence::AddSequence(std::string seq) {
 	if (!_seq.empty()) {
-		std::cout << "\nCSequence ERROR: Trying to added sequence to non-empty named sequence\n";
-		exit(-1);
+		throw CError("\nCSequence ERROR: Trying to added sequence to non-empty named sequence\n");
 	}
-	_seq = seq;
-	if(_seq.size() > _maxLength) { _maxLength = _seq.size(); }
+	_seq = std::move(seq);
 }
 std::string CSequence::Seq(int pos, bool filter, bool showOutside) {
-	std::stringstream ss;
+	const std::vector <bool> &Inside = Flags().Inside, &Remove = Flags().Remove;
+	std::string ss;
 	if(pos != -1) {
-		if(!showOutside && !Inside[pos]) { ss << "0"; }
-		else if(filter && Remove[pos]) { ss <<_filterOut; }
-		else { ss << _seq[pos]; }
+		if(!showOutside && !Inside[pos]) { ss.push_back('0'); }
+		else if(filter && Remove[pos]) { ss.push_back(_filterOut); }
+		else { ss.push_back(_seq[pos]); }
 
 	} else {
-		for( int i = 0 ; i < _seq.size(); i++) {
+		ss.reserve(_seq.size());
+		for( size_t i = 0 ; i < _seq.size(); i++) {
 			if(!showOutside && !Inside[i]) { continue; }
-			if(filter && Remove[i]) { ss <<_filterOut; }
-			else { ss << _seq[i]; }
+			if(filter && Remove[i]) { ss.push_back(_filterOut); }
+			else { ss.push_back(_seq[i]); }
 		}
 	}
-	return ss.str();
+	return ss;
 }
 std::string CSequence::RealSeq(int pos) {
 	if(pos != -1) {
@@ -57,40 +68,85 @@ std::string CSequence::RealSeq(int pos) {
 	return _seq;
 }
 bool CSequence::Filter(int pos) {
-	if(Remove[pos] || !Inside[pos]) { return true; }
+	if(Flags().Remove[pos] || !Flags().Inside[pos]) { return true; }
 	return false;
 }
 
 
 /////////////// Minor functions
 // File reader
-std::vector <CSequence> *ReadSequences(std::string seqFile) {
-	vector <CSequence> *ret = NULL;
-	switch(TestFile(seqFile)) {
-	case FASTA:
-		ret = FASTAReader(seqFile); break;
-	case MSF:
-		ret = MSFReader(seqFile); break;
-	case Interleaved:
-		ret = InterleavedReader(seqFile); break;
-	case Phylip:
-		ret = PhylipReader(seqFile); break;
-	default:
-		std::cerr << "\nError: cannot work out format of file " << seqFile;
+// ---
+// The input is only read once. A compressed file is parsed as it is inflated, so its format is worked out from the first
+// inflated block; anything else, stdin included, is read into one buffer (mapped where possible) that the format is
+// worked out from and then parsed. Compressed stdin cannot be recognised before it is read, so it is inflated into that buffer
+static std::vector <CSequence> *StreamReader(EFileType type, istream &input, const string &seqFile) {
+	switch(type) {
+	case FASTA: return FASTAReader(input);
+	case MSF: return MSFReader(input);
+	case Interleaved: return InterleavedReader(input, seqFile);
+	case Phylip: return PhylipReader(input, seqFile);
+	default: throw CError("\nError: cannot work out format of file " + seqFile);
+	}
+}
+std::vector <CSequence> *ReadSequences(std::string seqFile, int threads, const SAlphabet &alphabet, const TWarning &warning, long long memoryBudget) {
+	unique_ptr <vector <CSequence> > ret;
+	EFileType type;
+	long long bytes = 0;
+	if(seqFile != "-" && IsGzipFile(seqFile)) {
+		CGzipStreamBuf inflated(seqFile);
+		{	CPhaseTimer timer(SniffPhase);
+			SCharSpan start = inflated.Peek();
+			CBufferStream sniff(start.data, start.size);
+			type = TestFormat(sniff, alphabet, warning);
+		}
+		CPhaseTimer timer(ReadPhase);
+		istream input(&inflated);
+		input.exceptions(ios::badbit);
+		ret.reset(StreamReader(type, input, seqFile));
+		struct stat info;
+		if(stat(seqFile.c_str(), &info) == 0) { bytes = info.st_size; }
+	} else {
+		unique_ptr <CFileBuffer> buffer;
+		{	CPhaseTimer timer(SniffPhase);
+			buffer.reset(new CFileBuffer(seqFile));
+			CBufferStream sniff(buffer->Data(), buffer->Size());
+			type = TestFormat(sniff, alphabet, warning);
+		}
+		// Parsing brings the whole buffer into memory and copies its sequences out of it
+		CheckMemory(memoryBudget, "reading " + seqFile, 2 * (long long)buffer->Size());
+		CPhaseTimer timer(ReadPhase);
+		CBufferStream input(buffer->Data(), buffer->Size());
+		if(threads > 1 && type == FASTA) { ret.reset(ParallelFASTAReader(*buffer, threads)); }
+		else if(threads > 1 && type == Interleaved) { ret.reset(ParallelInterleavedReader(*buffer, seqFile, threads)); }
+		else if(threads > 1 && type == Phylip) { ret.reset(ParallelPhylipReader(*buffer, seqFile, threads)); }
+		else if(type == FASTA) { ret.reset(FASTAReader(buffer->Data(), buffer->Data() + buffer->Size())); }
+		else { ret.reset(StreamReader(type, input, seqFile)); }
+		bytes = buffer->Size();
 	}
+	CheckMemory(memoryBudget, "reading " + seqFile);
 	if(ret->size() == 0) {
-		cerr << "\nError in reading file " << seqFile << "? Couldn't find sequences when looking under format " << FileTypeName(TestFile(seqFile)) << endl;
-		exit(-1);
+		throw CError("\nError in reading file " + seqFile + "? Couldn't find sequences when looking under format " + FileTypeName(type) + "\n");
+	}
+	if(profiling) {
+		ProfileCount(ByteCount, bytes);
+		ProfileCount(SeqCount, ret->size());
+		for(auto &s : *ret) { ProfileCount(ResidueCount, count_if(s.RawSeq().begin(), s.RawSeq().end(), [&](char c) { return !alphabet.IsGap(c); })); }
 	}
-	return ret;
+	return ret.release();
+}
+std::vector <CSequence> *ReadBuffer(const char *begin, const char *end, const std::string &seqFile, const SAlphabet &alphabet, const TWarning &warning) {
+	if(end - begin >= 2 && (unsigned char)begin[0] == 0x1f && (unsigned char)begin[1] == 0x8b) { throw CError("\nError: " + seqFile + " is compressed; send it uncompressed\n"); }
+	CBufferStream sniff(begin, end - begin);
+	EFileType type = TestFormat(sniff, alphabet, warning);
+	CBufferStream input(begin, end - begin);
+	unique_ptr <vector <CSequence> > ret(type == FASTA ? FASTAReader(begin, end) : StreamReader(type, input, seqFile));
+	if(ret->size() == 0 || ret->at(0).Name().empty()) {
+		throw CError("\nError in reading " + seqFile + "? Couldn't find sequences when looking under format " + FileTypeName(type) + "\n");
+	}
+	return ret.release();
 }
 // File tester
-EFileType TestFile(std::string SeqFile) {
-	std::ifstream input(SeqFile.c_str(), std::ifstream::in);
-    if(!input.good()){
-        std::cerr << "Error opening '"<< SeqFile <<"'. Provide a valid file." << std::endl;
-        exit(-1);
-    }
+EFileType TestFormat(std::istream &input, const SAlphabet &alphabet, const TWarning &warning) {
     std::string line;
     std::vector<std::string> Toks;
     while(getline( input, line ) ) {
@@ -99,7 +155,7 @@ EFileType TestFile(std::string SeqFile) {
     		while(getline( input, line ) ) {
     			if(!line.empty()) {
     				line = RemoveWhiteSpace(line);
-    				if(IsSeq(line[0]) || IsGap(line[0])) { return FASTA; }
+    				if(anyResidue.Residue(line[0]) || alphabet.IsGap(line[0])) { return FASTA; }
     				break;
     	} 	}	}
     	// MSF
@@ -107,7 +163,7 @@ EFileType TestFile(std::string SeqFile) {
     		while(getline( input, line ) ) {
     			if(line[0] == '/' && line[1] == '/') { return MSF; }
     		}
-    		cerr << "\nFound something that looks like MSF format, but doesn't appear to have sequences\n"; exit(-1);
+    		throw CError("\nFound something that looks like MSF format, but doesn't appear to have sequences\n");
     	}
     	// Phylip/Interleaved
     	Toks = Tokenise(line);
@@ -120,64 +176,111 @@ EFileType TestFile(std::string SeqFile) {
     					if(Toks.size() == 1) { return Interleaved; } // If next line contains only a single token then it's interleaved
     					else {
     						bool flag = true;
-    						for(int i = 1; i < Toks.size() ; i++) {
-    							for(auto &c : Toks[i]) { if(!IsSeq(c) && !IsGap(c)) { flag = false; } }
+    						for(size_t i = 1; i < Toks.size() ; i++) {
+    							for(auto &c : Toks[i]) { if(!anyResidue.Residue(c) && !alphabet.IsGap(c)) { flag = false; } }
 
     						}
     						if(flag) { return Phylip; }
     					}
-    					cerr << "\nWeird format on line: " << line;
-    					cerr << "\nExpected either a sequence name or a sequence name followed by sequence, but got unexpected characters";
+    					if(warning) { warning("\nWeird format on line: " + line + "\nExpected either a sequence name or a sequence name followed by sequence, but got unexpected characters"); }
     }	}	}	}	}
     // If not sure, then assume FASTA
-    cout << "\nWARNING: Unknown sequence format. Cowardly assuming FASTA...\n";
+    if(warning) { warning("\nWARNING: Unknown sequence format. Cowardly assuming FASTA...\n"); }
     return FASTA;
 }
 
 // File readers
-std::vector <CSequence> *FASTAReader(std::string SeqFile) {
+std::vector <CSequence> *FASTAReader(const char *begin, const char *end) {
 	std::vector <CSequence> *RetSeq = new std::vector<CSequence>();
-
-	std::ifstream input(SeqFile.c_str(), std::ifstream::in);
-    if(!input.good()){
-        std::cerr << "Error opening '"<< SeqFile <<"'. Provide a valid file." << std::endl;
-        exit(-1);
-    }
-    std::string line, name, content;
-    while(getline( input, line ) ){
-    	line = RemoveWhiteSpace(line);
-        if( line.empty() || line[0] == '>' ){ // Identifier marker
-            if( !line.empty() ){
-            	if(!name.empty()) { // Push the sequence back
-            		RetSeq->push_back(CSequence(RemoveWhiteSpace(name),RemoveWhiteSpace(content)));
-            		name.clear(); content.clear();
-            	}
-                name = line.substr(1);
-            }
-            content.clear();
-        } else if( !name.empty() ){
-            if( line.find(' ') != std::string::npos ){ // Invalid sequence--no spaces allowed
-                name.clear();
-                content.clear();
-            } else {
-                content += line;
-            }
-        }
-    }
-    // Add the final sequence
-    RetSeq->push_back(CSequence(RemoveWhiteSpace(name),RemoveWhiteSpace(content)));
-    return RetSeq;
+	ScanFASTA(begin, end, [&](SFASTARecord &r) {
+		RetSeq->push_back(CSequence(r.TakeName(),r.TakeSeq()));
+	});
+	return RetSeq;
 }
-std::vector <CSequence> *MSFReader(std::string SeqFile) {
-	vector <CSequence> *RetSeq = new std::vector<CSequence>();
+// The stream is scanned a block at a time, cutting each block before its last '>' line so that only whole records are scanned
+std::vector <CSequence> *FASTAReader(std::istream &input) {
+	unique_ptr <vector <CSequence> > RetSeq(new std::vector<CSequence>());
+	auto add = [&](SFASTARecord &r) { RetSeq->push_back(CSequence(r.TakeName(),r.TakeSeq())); };
+	string text;
+	vector <char> block(1 << 16);
+	size_t searched = 0;		// text before this has no '>' line to cut at
+	while(input.read(block.data(), block.size()), input.gcount() > 0) {
+		text.append(block.data(), input.gcount());
+		size_t cut = 0;
+		for(size_t k = text.size(); k-- > my_max(searched, (size_t)1); ) {
+			if(text[k] == '>' && text[k - 1] == '\n') { cut = k; break; }
+		}
+		searched = text.size();
+		if(cut == 0) { continue; }
+		ScanFASTA(text.data(), text.data() + cut, add, false);
+		text.erase(0, cut);
+		searched -= cut;
+	}
+	ScanFASTA(text.data(), text.data() + text.size(), add);
+	return RetSeq.release();
+}
+// Scan a FASTA buffer, handing each record to record() in file order
+// ---
+// Follows the line-based reading rules: white space is removed from every line; a line starting with '>' starts a new record
+// (a record is only handed out if it has a name, apart from the final one which always is); an empty line discards the sequence
+// read so far; and lines before the first name are ignored. Lines are found with memchr and a name or single line sequence
+// without internal white space is handed out as a view without copying
+static inline bool IsSpaceChar(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f'; }
+static void AppendStripped(std::string &to, const char *b, const char *e) {
+	while(b < e) {
+		const char *run = b;
+		while(b < e && !IsSpaceChar(*b)) { b++; }
+		to.append(run, b - run);
+		while(b < e && IsSpaceChar(*b)) { b++; }
+	}
+}
+// Sets span to the white space stripped [b,e), using store only if there is white space inside the text
+static void StripToSpan(const char *b, const char *e, SCharSpan &span, std::string &store) {
+	while(b < e && IsSpaceChar(*b)) { b++; }
+	while(e > b && IsSpaceChar(*(e - 1))) { e--; }
+	const char *p = b;
+	while(p < e && !IsSpaceChar(*p)) { p++; }
+	if(p == e) { span.data = b; span.size = e - b; return; }
+	store.assign(b, p - b);
+	AppendStripped(store, p, e);
+	span.data = store.data(); span.size = store.size();
+}
+void ScanFASTA(const char *begin, const char *end, const std::function<void(SFASTARecord &)> &record, bool finalChunk) {
+	SFASTARecord r;
+	int lines = 0;			// Number of sequence lines in the current record
+	auto clearSeq = [&]() { r.seq = SCharSpan(); r.seqStore.clear(); lines = 0; };
+	const char *p = begin;
+	while(p < end) {
+		const char *lineEnd = (const char *)memchr(p, '\n', end - p);
+		const char *next = lineEnd == nullptr ? end : lineEnd + 1;
+		if(lineEnd == nullptr) { lineEnd = end; }
+		const char *first = p;
+		while(first < lineEnd && IsSpaceChar(*first)) { first++; }
+		if(first == lineEnd) { clearSeq(); }
+		else if(*first == '>') {
+			if(r.name.size > 0) { record(r); }
+			r = SFASTARecord();
+			StripToSpan(first + 1, lineEnd, r.name, r.nameStore);
+			clearSeq();
+		} else if(r.name.size > 0) {
+			if(lines == 0) { StripToSpan(first, lineEnd, r.seq, r.seqStore); }
+			else {
+				if(r.seq.data != r.seqStore.data()) { r.seqStore.assign(r.seq.data, r.seq.size); }
+				AppendStripped(r.seqStore, first, lineEnd);
+				r.seq.data = r.seqStore.data(); r.seq.size = r.seqStore.size();
+			}
+			lines++;
+		}
+		p = next;
+	}
+	// Add the final sequence
+	if(finalChunk || r.name.size > 0) { record(r); }
+}
+std::vector <CSequence> *MSFReader(std::istream &input) {
+	unique_ptr <vector <CSequence> > RetSeq(new std::vector<CSequence>());
 	vector <std::string> Names;
 	vector<std::string> Toks;
-	ifstream input(SeqFile.c_str(), std::ifstream::in);
 	string line;
-    if(!input.good()){
-        std::cerr << "Error opening '"<< SeqFile <<"'. Provide a valid file." << std::endl;
-        exit(-1);
-    }
     // Read the file names from the header
     while(getline( input, line ) ){
     	if(line.size() < 2) { continue; }
@@ -185,59 +288,49 @@ std::vector <CSequence> *MSFReader(std::string SeqFile) {
     	Toks = Tokenise(line);
     	if(Toks[0] == "Name:") { Names.push_back(Toks[1]); }
     }
-    if(Names.empty()) { std::cerr << "\nCouldn't find names in MSF file header. They should occur after Name:\n"; exit(-1); }
-    for(auto &n1 : Names) {
-    	int count = 0;
-    	for(auto &n2 : Names) {
-    		if(n1 == n2) { count ++; }
-    	}
-    	if(count != 1) { std::cerr << "\nMultiple copies of name " << n1 << "?\n"; exit(-1); }
+    if(Names.empty()) { throw CError("\nCouldn't find names in MSF file header. They should occur after Name:\n"); }
+    // Index the names, so each body line finds its row in constant time
+    unordered_map <string, int> Rows;
+    Rows.reserve(Names.size());
+    for(int i = 0 ; i < (int)Names.size(); i++) {
+    	if(!Rows.emplace(Names[i], i).second) { throw CError("\nMultiple copies of name " + Names[i] + "?\n"); }
     }
-    std::vector <std::stringstream> Seqstream(Names.size());
+    std::vector <std::string> Seqs(Names.size());
     while(getline( input, line ) ){
     	Toks = Tokenise(line);
     	if(Toks.size() < 2) { continue; }
-    	// Find the name
-    	for(int i = 0 ; i < Names.size(); i++) {
-    		if(Toks[0] == Names[i]) {
-    			for(int j = 1; j < Toks.size(); j++) { Seqstream[i] << Toks[j]; }
-    			break;
-    		}
-    	}
+    	auto row = Rows.find(Toks[0]);
+    	if(row == Rows.end()) { continue; }
+    	for(size_t j = 1; j < Toks.size(); j++) { Seqs[row->second] += Toks[j]; }
     }
-    for(int i = 0 ; i < Names.size(); i++) {
-    	if(Seqstream[i].str().size() != Seqstream[0].str().size()) {
-    		std::cerr << "\nERROR: Some sequences seem of different lengths?\n"; exit(-1);
+    for(size_t i = 0 ; i < Names.size(); i++) {
+    	if(Seqs[i].size() != Seqs[0].size()) {
+    		throw CError("\nERROR: Some sequences seem of different lengths?\n");
     	}
-    	RetSeq->push_back(CSequence(RemoveWhiteSpace(Names[i]),RemoveWhiteSpace(Seqstream[i].str())));
+    	RetSeq->push_back(CSequence(RemoveWhiteSpace(Names[i]),RemoveWhiteSpace(Seqs[i])));
     }
-    return RetSeq;
+    return RetSeq.release();
 }
-std::vector <CSequence> *InterleavedReader(std::string SeqFile) {
+std::vector <CSequence> *InterleavedReader(std::istream &input, const std::string &SeqFile) {
 	int noSeq = -1, length;
-	vector <CSequence> *RetSeq = new std::vector<CSequence>();
+	unique_ptr <vector <CSequence> > RetSeq(new std::vector<CSequence>());
 	vector <std::string> Names;
 	vector<std::string> Toks;
-	ifstream input(SeqFile.c_str(), std::ifstream::in);
 	string line;
-    if(!input.good()){
-        std::cerr << "Error opening '"<< SeqFile <<"'. Provide a valid file." << std::endl;
-        exit(-1);
-    }
     // Get the line specifying number of sequences and their length
     while(getline( input, line ) ){
     	if(line.size() < 1) { continue; }
     	if(line[0] == '#') { continue; }
     	Toks = Tokenise(line);
-    	if(Toks.size() != 2) { cerr << "\nError: first line in a phylip format file should be #seq length"; exit(-1); }
+    	if(Toks.size() != 2) { throw CError("\nError: first line in a phylip format file should be #seq length"); }
     	noSeq = atoi(Toks[0].c_str()); assert(noSeq > 0);
     	length = atoi(Toks[1].c_str()); assert(length > 0);
     	break;
     }
-    if(noSeq < 0) { cerr << "\nCouldn't find number of sequences in file: " << SeqFile << "?\n"; exit(-1); }
+    if(noSeq < 0) { throw CError("\nCouldn't find number of sequences in file: " + SeqFile + "?\n"); }
     Names.assign(noSeq,"");
     std::vector <std::stringstream> Seqstream(Names.size());
-    for(int i = 0; i< Names.size(); i++) {
+    for(size_t i = 0; i< Names.size(); i++) {
         while(getline( input, line ) ){
         	if(line.size() < 1) { continue; }
         	if(line[0] == '#') { continue; }
@@ -252,36 +345,31 @@ std::vector <CSequence> *InterleavedReader(std::string SeqFile) {
 			if(Seqstream[i].tellg() >= length) { break; }
 		}
     }
-    for(int i = 0 ; i < Names.size(); i++) {
+    for(size_t i = 0 ; i < Names.size(); i++) {
      	if(Seqstream[i].str().size() != Seqstream[0].str().size()) {
-     		std::cerr << "\nERROR: Some sequences seem of different lengths?\n"; exit(-1);
+     		throw CError("\nERROR: Some sequences seem of different lengths?\n");
      	}
      	RetSeq->push_back(CSequence(RemoveWhiteSpace(Names[i]),RemoveWhiteSpace(Seqstream[i].str())));
      }
-    return RetSeq;
+    return RetSeq.release();
 }
-std::vector <CSequence> *PhylipReader(std::string SeqFile) {
+std::vector <CSequence> *PhylipReader(std::istream &input, const std::string &SeqFile) {
 	int noSeq = -1, length;
-	vector <CSequence> *RetSeq = new std::vector<CSequence>();
+	unique_ptr <vector <CSequence> > RetSeq(new std::vector<CSequence>());
 	vector <std::string> Names;
 	vector<std::string> Toks;
-	ifstream input(SeqFile.c_str(), std::ifstream::in);
 	string line;
-    if(!input.good()){
-        std::cerr << "Error opening '"<< SeqFile <<"'. Provide a valid file." << std::endl;
-        exit(-1);
-    }
     // Get the line specifying number of sequences and their length
     while(getline( input, line ) ){
     	if(line.size() < 1) { continue; }
     	if(line[0] == '#') { continue; }
     	Toks = Tokenise(line);
-    	if(Toks.size() != 2) { cerr << "\nError: first line in a phylip format file should be #seq length"; exit(-1); }
+    	if(Toks.size() != 2) { throw CError("\nError: first line in a phylip format file should be #seq length"); }
     	noSeq = atoi(Toks[0].c_str()); assert(noSeq > 0);
     	length = atoi(Toks[1].c_str()); assert(length > 0);
     	break;
     }
-    if(noSeq < 0) { cerr << "\nCouldn't find number of sequences in file: " << SeqFile << "?\n"; exit(-1); }
+    if(noSeq < 0) { throw CError("\nCouldn't find number of sequences in file: " + SeqFile + "?\n"); }
     Names.assign(noSeq,"");
     std::vector <std::stringstream> Seqstream(Names.size());
     // Go through the rest of the file
@@ -291,20 +379,20 @@ std::vector <CSequence> *PhylipReader(std::string SeqFile) {
     	// Hard fixed loop of noSeq with no gaps
     	for(int i = 0; i < noSeq; i++) {
     		Toks = Tokenise(line);
-    		if(Toks.empty()) { cerr << "\nError: unexpected line between sequences where " << Names[i] << " is expected"; }
+    		if(Toks.empty()) { throw CError("\nError: unexpected line between sequences where " + Names[i] + " is expected"); }
     		if(Names[i].empty()) { Names[i] = Toks[0]; }
     		if(Toks[0] == Names[i]) { Toks.erase(Toks.begin()); }
     		for(auto & s : Toks) { Seqstream[i] << s; }
     		if(i < noSeq - 1) { if(!getline( input, line )) { break; } }
     	}
     }
-    for(int i = 0 ; i < Names.size(); i++) {
+    for(size_t i = 0 ; i < Names.size(); i++) {
      	if(Seqstream[i].str().size() != Seqstream[0].str().size()) {
-     		std::cerr << "\nERROR: Some sequences seem of different lengths?\n"; exit(-1);
+     		throw CError("\nERROR: Some sequences seem of different lengths?\n");
      	}
      	RetSeq->push_back(CSequence(RemoveWhiteSpace(Names[i]),RemoveWhiteSpace(Seqstream[i].str())));
      }
-     return RetSeq;
+     return RetSeq.release();
 }
 
 std::string RemoveWhiteSpace(std::string s) {
@@ -326,7 +414,7 @@ std::vector <std::string> Tokenise(std::string line) {
 std::vector <std::string> Tokenise(std::string line, std::string Delim)	{
 	size_t i = 0, j,j1;
 	std::vector <std::string> Toks;
-	while(i != (int)line.size())	{
+	while(i != line.size())	{
 		j = line.find(Delim,i+1);
 		if(j == std::string::npos) { j = j1 = (int)line.size(); } else { j1 = j+1; }
 		Toks.push_back(line.substr(i,j-i));
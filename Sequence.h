@@ -8,6 +8,7 @@
 #ifndef SEQUENCE_H_
 #define SEQUENCE_H_
 #include <algorithm>
+#include <atomic>
 #include <sys/stat.h>
 #include <unistd.h>
 #include <unordered_map>
@@ -17,58 +18,74 @@
 #include <cassert>
 #include <iostream>
 #include <fstream>
+#include <functional>
+#include <memory>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include "Alphabet.h"
 
-const std::string AA_ABET  = "ARNDCQEGHILKMFPSTWYV";
+const std::string AA_ABET  = AMINO_ACIDS;
 #define BIG_NUMBER 1000000
 
+// Errors in the input files or in the comparison asked for. The message is what used to be printed before exiting; the
+// command line catches it in main() and still prints it and exits, while the server reports it and carries on
+class CError : public std::runtime_error {
+public:
+	CError(const std::string &message) : std::runtime_error(message) { }
+};
+// Warnings about the inputs are passed to one of these, as the message that used to be printed, rather than printed. The
+// command line prints them to stderr; an empty one drops them
+typedef std::function<void(const std::string &)> TWarning;
+
 // Basic class for sequences
+// ---
+// Scoring only reads the name and the raw sequence, so that is all a sequence holds until one of the filter functions is
+// used: the filter state is then allocated and initialised on first use
 class CSequence {
 public:
+	struct SFilterFlags {
+		std::vector <bool> Inside;				// Whether the character is on the inside or outside
+		std::vector <bool> Remove;				// Whether to remove in the filter (true = remove)
+		double PropInside = 0;					// The proportion of the sequence labeled inside
+		double PropRemoved = 0;					// The proportion of hte sequence labeled to be removed
+		bool allRemoved = false;				// Whether the sequence is fully removed
+	};
 	CSequence() { };								// Blank constructor
 	CSequence(std::string name, std::string seq);	// Standard constructor
-//	std::string name;
-//	std::string seq;
-	std::vector <bool> Inside;					// Whether the character is on the inside or outside
-	std::vector <bool> Remove;					// Whether to remove in the filter (true = remove)
-	double PropInside;							// The proportion of the sequence labeled inside
-	double PropRemoved;							// The proportion of hte sequence labeled to be removed
-	bool AllRemoved() { return _allRemoved; }
+	CSequence(const CSequence &seq) : _name(seq._name), _seq(seq._seq), _flags(seq._flags ? new SFilterFlags(*seq._flags) : nullptr) { }
+	CSequence(CSequence &&seq) = default;
+	CSequence &operator=(const CSequence &seq) { CSequence copy(seq); return *this = std::move(copy); }
+	CSequence &operator=(CSequence &&seq) = default;
+	SFilterFlags &Flags();							// The filter state, everything inside and nothing removed until changed
+	bool AllRemoved() { return Flags().allRemoved; }
 	void AddSequence(std::string seq);
 	void AddName(std::string name);
 	static void SetFilter(char filterOut) { _filterOut = filterOut; };
 	int length() { return _seq.size(); }
-	static int MaxLength() { return _maxLength; }
 	std::string RealSeq(int pos = -1);				// Outputs the unfiltered seq
+	const std::string &RawSeq() const { return _seq; }	// The unfiltered seq without copying it
 	std::string Seq(int pos = -1, bool filter = true, bool showOutside = false);		// Output the sequence (or pos i of sequence)
-	std::string Name() { return _name; }
+	const std::string &Name() const { return _name; }
 	bool Filter(int pos);					// Whether pos should be filtered/removed in any way
 
 	std::string out() { return _name + " " + _seq; }
 	void CalculateSummary() {
+		SFilterFlags &flags = Flags();
 		int in = 0, rem = 0;
 		for(int i = 0; i < length(); i++) {
-			if(Inside[i]) { in++; }
-			if(Remove[i]) { rem++; }
+			if(flags.Inside[i]) { in++; }
+			if(flags.Remove[i]) { rem++; }
 		}
-		PropInside = (double) in / (double) length();
-		PropRemoved = (double) rem / (double) length();
-		if(rem == length()) { _allRemoved = true; }
+		flags.PropInside = (double) in / (double) length();
+		flags.PropRemoved = (double) rem / (double) length();
+		if(rem == length()) { flags.allRemoved = true; }
 	}
 private:
-	static int _maxLength;		// Maximum length of the sequences examined
-	std::string _name;			// The sequence
-	std::string _seq;			// The name
+	std::string _name;			// The name
+	std::string _seq;			// The sequence
+	std::unique_ptr <SFilterFlags> _flags;		// Only allocated by Flags()
 	static char _filterOut;		// The string output on filtering
-	bool _allRemoved = false;	// Whether the sequence is fully removed
-
-	void InitialiseFlags() {
-		assert(Inside.empty() && Remove.empty());
-		Inside.assign(_seq.size(),true);
-		Remove.assign(_seq.size(),false);
-	}
-
 };
 
 // File readers
@@ -84,15 +101,50 @@ inline std::string FileTypeName(EFileType type) {
 	case Interleaved:
 		return "Interleaved";
 	default:
-		std::cout << "\nUknown FileTypeName..."; exit(-1);
+		throw CError("\nUknown FileTypeName...");
 	}
 }
-EFileType TestFile(std::string seqFile);
-std::vector <CSequence> *ReadSequences(std::string seqFile);
-std::vector <CSequence> *FASTAReader(std::string seqFile);
-std::vector <CSequence> *MSFReader(std::string seqFile);
-std::vector <CSequence> *PhylipReader(std::string seqFile);
-std::vector <CSequence> *InterleavedReader(std::string seqFile);
+// A read-only view of characters, e.g. into a memory mapped file
+struct SCharSpan {
+	const char *data = nullptr;
+	size_t size = 0;
+	std::string str() const { return std::string(data, size); }
+};
+// A FASTA record handed out by ScanFASTA. The name and sequence are views into the buffer when they can be; only a name
+// containing white space, or a sequence split over several lines, is copied into the record's own storage
+struct SFASTARecord {
+	SCharSpan name;
+	SCharSpan seq;
+	std::string nameStore, seqStore;
+	std::string TakeName() { return name.data == nameStore.data() ? std::move(nameStore) : name.str(); }
+	std::string TakeSeq() { return seq.data == seqStore.data() ? std::move(seqStore) : seq.str(); }
+};
+// Scan [begin,end) for FASTA records. A buffer split into chunks at '>' lines can be scanned chunk by chunk, with finalChunk
+// false for all but the last so that a trailing record is only handed out if it has a name
+void ScanFASTA(const char *begin, const char *end, const std::function<void(SFASTARecord &)> &record, bool finalChunk = true);
+
+// Works out the format from the start of the input, reading only as far as it needs; the alphabet says which characters
+// can start a row of sequence
+EFileType TestFormat(std::istream &input, const SAlphabet &alphabet = SAlphabet(), const TWarning &warning = TWarning());
+// "-" reads stdin. FASTA/Phylip/Interleaved are parsed in parallel when threads > 1. Reading fails with CError if it would
+// take the process over memoryBudget bytes (see CheckMemory); 0 is no limit
+std::vector <CSequence> *ReadSequences(std::string seqFile, int threads = 1, const SAlphabet &alphabet = SAlphabet(), const TWarning &warning = TWarning(), long long memoryBudget = 0);
+// As ReadSequences, for an input already in memory
+std::vector <CSequence> *ReadBuffer(const char *begin, const char *end, const std::string &seqFile, const SAlphabet &alphabet = SAlphabet(), const TWarning &warning = TWarning());
+// The readers parse an input opened by ReadSequences; the file name is only used in messages
+std::vector <CSequence> *FASTAReader(const char *begin, const char *end);
+std::vector <CSequence> *FASTAReader(std::istream &input);
+std::vector <CSequence> *MSFReader(std::istream &input);
+std::vector <CSequence> *PhylipReader(std::istream &input, const std::string &seqFile);
+std::vector <CSequence> *InterleavedReader(std::istream &input, const std::string &seqFile);
+// Parallel versions of the readers (ParallelReaders.cpp). They give the same sequences as the serial readers and fall back
+// to them for anything irregular, so errors are reported in the same way. The input is split into at most threads chunks
+// of at least chunkBytes
+class CFileBuffer;
+const size_t minChunkBytes = 1 << 20;		// Inputs aren't split into chunks smaller than this
+std::vector <CSequence> *ParallelFASTAReader(const CFileBuffer &input, int threads, size_t chunkBytes = minChunkBytes);
+std::vector <CSequence> *ParallelPhylipReader(const CFileBuffer &input, const std::string &seqFile, int threads, size_t chunkBytes = minChunkBytes);
+std::vector <CSequence> *ParallelInterleavedReader(const CFileBuffer &input, const std::string &seqFile, int threads, size_t chunkBytes = minChunkBytes);
 
 // Other minor tools
 template <class TRange> bool InRange(TRange Val, TRange LowerBound, TRange UpperBound) { return ( !(Val < LowerBound) && ( Val < UpperBound) ); }
@@ -126,21 +178,10 @@ inline bool file_exist (const std::string& name) {
 inline std::string read_line(std::istream &in) {
 	std::string tmp;
 	getline(in,tmp);
-	if(!in.good()) { std::cout << "\nError reading file..."; exit(-1); }
+	if(!in.good()) { throw CError("\nError reading file..."); }
 	return tmp;
 }
 
-inline bool IsGap(char c) {
-	std::string gaps = ".*-X?";
-	if(std::find(gaps.begin(),gaps.end(),c) != gaps.end()) { return true; }
-	return false;
-}
-
-inline bool IsSeq(char c) {
-	if(std::find(AA_ABET.begin(),AA_ABET.end(),c) != AA_ABET.end()) { return true; }
-	return false;
-}
-
 template <typename T>
 std::vector<int> ordered(std::vector<T> const& values) {
     std::vector<int> indices(values.size());
@@ -0,0 +1,210 @@
+/*
+ * Server.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Server mode: scores requests sent over a Unix domain socket, keeping the indexed references in memory between requests
+ */
+
+#include "Server.h"
+#include "Library.h"
+#include "Parallel.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+using namespace::std;
+
+const size_t maxHeaderBytes = 1 << 16;		// Longest request header accepted
+const int idleSeconds = 30;					// A connection that sends or takes nothing for this long is closed
+
+// Warnings are only logged by the server, as the reply carries the same output as msascorer's stdout
+static void ServerWarning(const string &message) {
+	cerr << message;
+}
+
+// The indexed references, most recently used first. An entry is only used while the file keeps the modification time and
+// size it had when it was read. Requests hold a shared pointer, so an entry can be dropped while it is still being scored
+class CRefCache {
+public:
+	CRefCache(int capacity, int threads) : _capacity(capacity), _threads(threads) { }
+	shared_ptr <const CScoringReference> Get(const string &path);
+private:
+	struct SEntry {
+		string path;
+		struct timespec mtime;
+		off_t size;
+		shared_ptr <const CScoringReference> index;
+	};
+	int _capacity, _threads;
+	mutex _lock;
+	list <SEntry> _entries;
+};
+
+shared_ptr <const CScoringReference> CRefCache::Get(const string &path) {
+	struct stat info;
+	if(stat(path.c_str(), &info) != 0) { throw CError("Error opening '" + path + "'. Provide a valid file.\n"); }
+	{	lock_guard<mutex> guard(_lock);
+		for(auto e = _entries.begin(); e != _entries.end(); e++) {
+			if(e->path == path && e->size == info.st_size && e->mtime.tv_sec == info.st_mtim.tv_sec && e->mtime.tv_nsec == info.st_mtim.tv_nsec) {
+				_entries.splice(_entries.begin(), _entries, e);
+				return e->index;
+		}	}
+	}
+	// Read without holding the lock so requests for cached references are not held up
+	unique_ptr <vector <CSequence> > data(ReadAlignment(path, _threads, SAlphabet(), ServerWarning));
+	SEntry entry = { path, info.st_mtim, info.st_size, make_shared <const CScoringReference>(move(*data)) };
+	lock_guard<mutex> guard(_lock);
+	_entries.remove_if([&](const SEntry &e) { return e.path == path; });	// Earlier versions of the file
+	_entries.push_front(entry);
+	while((int)_entries.size() > _capacity) { _entries.pop_back(); }
+	return entry.index;
+}
+
+struct SRequest {
+	string test, ref, testName, refName;
+	string data;				// The test MSA when it is sent with the request
+	bool inlineTest = false;
+	EEngine engine = Pairs;
+	int threads = 1;
+};
+
+// One recv on a connection with the idle timeout set; a connection that times out is logged
+static size_t Receive(int fd, char *block, size_t size) {
+	ssize_t got = recv(fd, block, size, 0);
+	if(got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+		ServerWarning("\nWARNING: closing a connection that sent nothing for " + to_string(idleSeconds) + " seconds\n");
+		throw CError("\nError: nothing received for " + to_string(idleSeconds) + " seconds\n");
+	}
+	if(got <= 0) { throw CError("\nError: incomplete request\n"); }
+	return got;
+}
+
+// Reads the request header up to the empty line, and then any inline test MSA that follows it
+static SRequest ReadRequest(int fd, int threads) {
+	SRequest r;
+	r.threads = threads;
+	string buffer;
+	char block[1 << 16];
+	size_t end;
+	while((end = buffer.find("\n\n")) == string::npos) {
+		if(buffer.size() > maxHeaderBytes) { throw CError("\nError: request header too long\n"); }
+		buffer.append(block, Receive(fd, block, sizeof(block)));
+	}
+	size_t inlineBytes = 0;
+	istringstream header(buffer.substr(0, end + 1));
+	string line;
+	while(getline(header, line)) {
+		size_t split = line.find(' ');
+		string key = line.substr(0, split), value = split == string::npos ? "" : line.substr(split + 1);
+		if(key == "test") { r.test = value; }
+		else if(key == "ref") { r.ref = value; }
+		else if(key == "testname") { r.testName = value; }
+		else if(key == "refname") { r.refName = value; }
+		else if(key == "inline") { r.inlineTest = true; inlineBytes = strtoull(value.c_str(), NULL, 10); }
+		else if(key == "engine") {
+			if(value == "pairs") { r.engine = Pairs; }
+			else if(value == "columns") { r.engine = Columns; }
+			else if(value == "check") { r.engine = Check; }
+			else { throw CError("\nError: unknown engine " + value + " (expected pairs, columns or check)\n"); }
+		}
+		else if(key == "threads") { r.threads = ThreadCount(atoi(value.c_str())); }
+		else { throw CError("\nError: unexpected request line " + line + "\n"); }
+	}
+	if(r.ref.empty() || (r.test.empty() && !r.inlineTest)) { throw CError("\nError: a request needs a ref and a test or inline line\n"); }
+	if(r.ref == "-" || r.test == "-") { throw CError("\nError: the server cannot read stdin; send the test MSA with an inline line\n"); }
+	if(r.testName.empty()) { r.testName = r.inlineTest ? "-" : r.test; }
+	if(r.refName.empty()) { r.refName = r.ref; }
+	if(r.inlineTest) {
+		r.data = buffer.substr(end + 2);
+		while(r.data.size() < inlineBytes) {
+			r.data.append(block, Receive(fd, block, my_min(sizeof(block), inlineBytes - r.data.size())));
+		}
+		r.data.resize(inlineBytes);
+	}
+	return r;
+}
+
+// Scores the request in the same way as the command line and returns the reply
+static string Answer(const SRequest &r, CRefCache &cache) {
+	shared_ptr <const CScoringReference> ref = cache.Get(r.ref);
+	unique_ptr <vector <CSequence> > test(r.inlineTest ? ReadBuffer(r.data.data(), r.data.data() + r.data.size(), "the test MSA sent with the request", SAlphabet(), ServerWarning) : ReadAlignment(r.test, r.threads, SAlphabet(), ServerWarning));
+	int testSeq = test->size(), testLen = test->at(0).length();
+	SScoreOptions options;
+	options.engine = r.engine;
+	options.threads = r.threads;
+	options.warning = ServerWarning;
+	SScore score = ScoreAlignment(move(*test), *ref, options);
+	ostringstream out;
+	WriteComparing(out, r.testName, testSeq, testLen, r.refName, ref->Size(), ref->Length());
+	WriteScore(out, score);
+	ostringstream reply;
+	reply << "OK " << score.TP << " " << score.FP << " " << score.FN << " " << score.totalRef << " " << score.totalTest << "\n" << out.str();
+	return reply.str();
+}
+
+static void Serve(int fd, CRefCache &cache, int threads) {
+	string reply;
+	try { reply = Answer(ReadRequest(fd, threads), cache); }
+	catch(exception &e) { reply = string("ERROR\n") + e.what(); }
+	for(size_t sent = 0; sent < reply.size(); ) {
+		ssize_t put = send(fd, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+		if(put <= 0) { break; }		// The client has gone, or stopped reading for idleSeconds
+		sent += put;
+	}
+	close(fd);
+}
+
+// The socket is removed when the server is stopped with SIGINT or SIGTERM
+static char socketToRemove[sizeof(sockaddr_un::sun_path)];
+static void StopServer(int) {
+	unlink(socketToRemove);
+	_exit(0);
+}
+
+void RunServer(const string &socketPath, int cacheSize, int threads) {
+	struct sockaddr_un address;
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	if(socketPath.size() >= sizeof(address.sun_path)) { throw CError("\nError: socket path too long: " + socketPath + "\n"); }
+	strcpy(address.sun_path, socketPath.c_str());
+	int server = socket(AF_UNIX, SOCK_STREAM, 0);
+	if(server < 0) { throw CError("\nError: cannot create socket: " + string(strerror(errno)) + "\n"); }
+	// A socket left behind by a server that is no longer running is replaced; anything else at the path is left alone
+	struct stat info;
+	if(stat(socketPath.c_str(), &info) == 0 && S_ISSOCK(info.st_mode)) {
+		int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+		bool listening = probe >= 0 && connect(probe, (struct sockaddr *)&address, sizeof(address)) == 0;
+		if(probe >= 0) { close(probe); }
+		if(listening) { throw CError("\nError: a server is already listening on " + socketPath + "\n"); }
+		unlink(socketPath.c_str());
+	}
+	if(bind(server, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(server, SOMAXCONN) != 0) {
+		throw CError("\nError: cannot listen on " + socketPath + ": " + string(strerror(errno)) + "\n");
+	}
+	strcpy(socketToRemove, socketPath.c_str());
+	signal(SIGINT, StopServer);
+	signal(SIGTERM, StopServer);
+	signal(SIGPIPE, SIG_IGN);
+	cout << "#Listening on " << socketPath << " (cache:" << cacheSize << " references)" << endl;
+	CRefCache cache(cacheSize, threads);
+	while(true) {
+		int fd = accept(server, NULL, NULL);
+		if(fd < 0) {
+			if(errno == EINTR || errno == ECONNABORTED) { continue; }
+			throw CError("\nError: accepting a connection on " + socketPath + ": " + string(strerror(errno)) + "\n");
+		}
+		// A client that stops sending or reading would otherwise hold its thread forever
+		struct timeval idle = { idleSeconds, 0 };
+		setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &idle, sizeof(idle));
+		setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &idle, sizeof(idle));
+		thread([fd, threads, &cache]() { Serve(fd, cache, threads); }).detach();
+	}
+}
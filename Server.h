@@ -0,0 +1,36 @@
+/*
+ * Server.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Server mode: scores requests sent over a Unix domain socket, keeping the indexed references in memory between requests
+ *	---
+ *	Each connection carries one request and its reply. A request is a set of "key value" lines ended by an empty line:
+ *		ref PATH						the reference MSA (required)
+ *		test PATH						the test MSA, or
+ *		inline BYTES					the test MSA given as BYTES sent straight after the empty line, in any of the formats
+ *										msascorer reads other than compressed
+ *		testname NAME / refname NAME	how the files are named in the output (default: the paths)
+ *		engine pairs|columns|check		as the -engine option (default pairs)
+ *		threads N						as the -t option (default: the server's -t)
+ *	The reply is either
+ *		OK TruePos FalsePos FalseNeg totalRef totalTest
+ *	followed by the output msascorer would print for the comparison, or
+ *		ERROR
+ *	followed by the error message.
+ *	Paths are opened by the server, so they should be absolute. References are cached by path and modification time, so an
+ *	edited reference is read again. A connection that sends nothing, or reads nothing of its reply, for 30 seconds is
+ *	logged and closed
+ */
+
+#ifndef SERVER_H_
+#define SERVER_H_
+#include <string>
+
+const std::string defaultSocket = "/tmp/msascorer.sock";	// Used when neither -server nor MSASCORER_SOCKET gives one
+
+// Listens on socketPath until killed, answering each connection on its own thread. Up to cacheSize references are kept,
+// dropping the least recently used, and references are read with threads threads
+void RunServer(const std::string &socketPath, int cacheSize, int threads);
+
+#endif /* SERVER_H_ */
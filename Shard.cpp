@@ -0,0 +1,144 @@
+/*
+ * Shard.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Partial scores of one shard of the pairs, for splitting a comparison over many processes, and merging them back
+ */
+
+#include "Shard.h"
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace::std;
+
+#define SHARD_FORMAT "msascorer-shard-1"
+
+uint64_t AlignmentChecksum(const vector <CSequence> &data) {
+	uint64_t hash = 14695981039346656037ULL;
+	auto add = [&](const string &s) {
+		for(unsigned char c : s) { hash = (hash ^ c) * 1099511628211ULL; }
+		hash = (hash ^ '\n') * 1099511628211ULL;
+	};
+	for(auto &s : data) { add(s.Name()); add(s.RawSeq()); }
+	return hash;
+}
+
+SShardInput ShardInput(const string &file, const vector <CSequence> &data) {
+	SShardInput retInput;
+	retInput.file = file;
+	retInput.sequences = data.size();
+	retInput.length = data.empty() ? 0 : data[0].RawSeq().size();
+	retInput.checksum = AlignmentChecksum(data);
+	return retInput;
+}
+
+static string Quoted(const string &s) {
+	string retString = "\"";
+	for(char c : s) {
+		if(c == '"' || c == '\\') { retString += '\\'; }
+		retString += c;
+	}
+	return retString + "\"";
+}
+
+static string Hex(uint64_t value) {
+	char buffer[17];
+	snprintf(buffer, sizeof(buffer), "%016llx", (unsigned long long)value);
+	return buffer;
+}
+
+void WriteShard(const string &file, const SShard &shard) {
+	ostringstream out;
+	out << "{\n  \"format\": " << Quoted(SHARD_FORMAT) << ",\n  \"shard\": " << shard.shard + 1 << ",\n  \"shards\": " << shard.shards;
+	for(auto input : { make_pair("test", &shard.test), make_pair("ref", &shard.ref) }) {
+		string key = input.first;
+		out << ",\n  \"" << key << "_file\": " << Quoted(input.second->file) << ",\n  \"" << key << "_sequences\": " << input.second->sequences;
+		out << ",\n  \"" << key << "_length\": " << input.second->length << ",\n  \"" << key << "_checksum\": \"" << Hex(input.second->checksum) << "\"";
+	}
+	out << ",\n  \"gaps\": " << Quoted(shard.gaps) << ",\n  \"TP\": " << shard.score.TP << ",\n  \"FP\": " << shard.score.FP;
+	out << ",\n  \"FN\": " << shard.score.FN << ",\n  \"totalRef\": " << shard.score.totalRef << ",\n  \"totalTest\": " << shard.score.totalTest << "\n}\n";
+	ofstream outFile(file.c_str());
+	if(!outFile.good()) { throw CError("Error opening '" + file + "' for the shard score.\n"); }
+	outFile << out.str();
+	outFile.close();
+	if(outFile.fail()) { throw CError("Error writing '" + file + "'\n"); }
+}
+
+// Reads back what WriteShard wrote: a "key": value pair per line, the value a number or a quoted string
+SShard ReadShard(const string &file) {
+	ifstream in(file.c_str());
+	if(!in.good()) { throw CError("Error opening '" + file + "'. Provide a valid file.\n"); }
+	map <string, string> value;
+	string line;
+	while(getline(in, line)) {
+		size_t start = line.find('"'), end = start == string::npos ? start : line.find('"', start + 1);
+		size_t colon = end == string::npos ? end : line.find(':', end);
+		if(colon == string::npos) { continue; }
+		string key = line.substr(start + 1, end - start - 1), text;
+		size_t pos = line.find_first_not_of(" \t", colon + 1);
+		if(pos != string::npos && line[pos] == '"') {
+			for(pos++; pos < line.size() && line[pos] != '"'; pos++) {
+				if(line[pos] == '\\' && pos + 1 < line.size()) { pos++; }
+				text += line[pos];
+			}
+		} else if(pos != string::npos) { text = line.substr(pos, line.find_first_of(",}", pos) - pos); }
+		value[key] = text;
+	}
+	const char *keys[] = { "shard", "shards", "test_file", "test_sequences", "test_length", "test_checksum", "ref_file",
+			"ref_sequences", "ref_length", "ref_checksum", "gaps", "TP", "FP", "FN", "totalRef", "totalTest" };
+	if(value["format"] != SHARD_FORMAT) { throw CError("\nError: " + file + " is not a shard score file\n"); }
+	for(auto key : keys) {
+		if(value.find(key) == value.end()) { throw CError("\nError: " + file + " has no " + key + "\n"); }
+	}
+	SShard retShard;
+	try {
+		retShard.shard = stoi(value["shard"]) - 1;
+		retShard.shards = stoi(value["shards"]);
+		for(auto input : { make_pair(string("test"), &retShard.test), make_pair(string("ref"), &retShard.ref) }) {
+			input.second->file = value[input.first + "_file"];
+			input.second->sequences = stoi(value[input.first + "_sequences"]);
+			input.second->length = stoi(value[input.first + "_length"]);
+			input.second->checksum = stoull(value[input.first + "_checksum"], nullptr, 16);
+		}
+		retShard.gaps = value["gaps"];
+		retShard.score.TP = stoll(value["TP"]);
+		retShard.score.FP = stoll(value["FP"]);
+		retShard.score.FN = stoll(value["FN"]);
+		retShard.score.totalRef = stoll(value["totalRef"]);
+		retShard.score.totalTest = stoll(value["totalTest"]);
+	} catch(logic_error &) { throw CError("\nError: " + file + " is corrupt\n"); }
+	if(retShard.shards < 1 || retShard.shard < 0 || retShard.shard >= retShard.shards) { throw CError("\nError: " + file + " is corrupt\n"); }
+	return retShard;
+}
+
+static bool SameInput(const SShardInput &a, const SShardInput &b) {
+	return a.sequences == b.sequences && a.length == b.length && a.checksum == b.checksum;
+}
+
+// The file names are not compared, as shards run on different machines may see the inputs under different paths
+SShard MergeShards(const vector <string> &files) {
+	if(files.empty()) { throw CError("\nError: no shard files to merge\n"); }
+	SShard retShard = ReadShard(files[0]);
+	vector <string> found(retShard.shards);
+	found[retShard.shard] = files[0];
+	for(size_t k = 1; k < files.size(); k++) {
+		SShard shard = ReadShard(files[k]);
+		if(shard.shards != retShard.shards || !SameInput(shard.test, retShard.test) || !SameInput(shard.ref, retShard.ref) || shard.gaps != retShard.gaps) {
+			throw CError("\nError: " + files[k] + " is not from the same comparison as " + files[0] + "\n");
+		}
+		if(!found[shard.shard].empty()) { throw CError("\nError: " + files[k] + " and " + found[shard.shard] + " are both shard " + to_string(shard.shard + 1) + "\n"); }
+		found[shard.shard] = files[k];
+		retShard.score += shard.score;
+	}
+	string missing;
+	for(int s = 0; s < retShard.shards; s++) {
+		if(found[s].empty()) { missing += " " + to_string(s + 1); }
+	}
+	if(!missing.empty()) { throw CError("\nError: missing shards of " + to_string(retShard.shards) + ":" + missing + "\n"); }
+	retShard.shard = 0;
+	retShard.shards = 1;
+	return retShard;
+}
@@ -0,0 +1,45 @@
+/*
+ * Shard.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Partial scores of one shard of the pairs, for splitting a comparison over many processes, and merging them back
+ *	---
+ *	-shard k/n File scores the k-th of n slices of the pair triangle (ScorePairShard) and writes its totals to File as a small
+ *	JSON object with one key per line, along with the size and a checksum of each input. msascorer merge File ... checks that
+ *	the files are the n shards of one comparison, each exactly once, from the same inputs and gap characters, and prints the
+ *	sum exactly as the unsharded run would. The checksums are of the names and rows as read, so the same alignment gives the
+ *	same checksum whether it was read plain, compressed or from stdin.
+ */
+
+#ifndef SHARD_H_
+#define SHARD_H_
+#include "Scorer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct SShardInput {
+	std::string file;
+	int sequences = 0;
+	int length = 0;
+	uint64_t checksum = 0;
+};
+
+struct SShard {
+	int shard = 0;				// 0 based
+	int shards = 1;
+	SShardInput test;
+	SShardInput ref;
+	std::string gaps;			// The gap characters the shard was scored with
+	SScore score;
+};
+
+uint64_t AlignmentChecksum(const std::vector <CSequence> &data);	// 64 bit FNV-1a of the names and rows, in order
+SShardInput ShardInput(const std::string &file, const std::vector <CSequence> &data);
+// Problems are thrown as CError
+void WriteShard(const std::string &file, const SShard &shard);
+SShard ReadShard(const std::string &file);
+SShard MergeShards(const std::vector <std::string> &files);		// The sum of the n shards of one comparison, as shard 0 of 1
+
+#endif /* SHARD_H_ */
@@ -0,0 +1,87 @@
+/*
+ * Generator.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Synthetic test/reference MSA pairs for benchmarking
+ */
+
+#include "Generator.h"
+#include <random>
+
+using namespace::std;
+
+SGenMSA GenerateMSA(const SGenParams &params) {
+	mt19937 rng(params.seed);
+	uniform_real_distribution<double> u(0.0,1.0);
+	uniform_int_distribution<int> residue(0, AA_ABET.size() - 1);
+	SGenMSA msa;
+	for(int i = 0; i < params.nSeq; i++) {
+		string row(params.length, '-');
+		vector <int> columns;					// Columns holding a residue
+		for(int c = 0; c < params.length; c++) {
+			if(u(rng) >= params.gaps) { row[c] = AA_ABET[residue(rng)]; columns.push_back(c); }
+		}
+		if(columns.empty()) { row[0] = AA_ABET[residue(rng)]; columns.push_back(0); }
+		// The reference fragment
+		int keep = my_max(1, (int)(columns.size() * params.refFraction));
+		int first = uniform_int_distribution<int>(0, columns.size() - keep)(rng);
+		string ref(params.length, '-');
+		for(int k = first; k < first + keep; k++) { ref[columns[k]] = row[columns[k]]; }
+		// The test row with its own inserted gaps
+		string test = row;
+		for(int k = 0; k < params.inserted; k++) {
+			test.insert(test.begin() + uniform_int_distribution<int>(0, test.size())(rng), '-');
+		}
+		msa.names.push_back("seq" + to_string(i));
+		msa.ref.push_back(ref);
+		msa.test.push_back(test);
+	}
+	return msa;
+}
+
+string FileExtension(EFileType format) {
+	switch(format) {
+	case FASTA: return "fas";
+	case MSF: return "msf";
+	case Phylip: return "phy";
+	case Interleaved: return "int";
+	}
+	return "";
+}
+
+void WriteMSA(const string &file, EFileType format, const vector <string> &names, const vector <string> &seqs) {
+	const int width = 60;
+	ofstream out(file.c_str());
+	if(!out.good()) { throw CError("Error opening '" + file + "' for writing.\n"); }
+	size_t length = seqs.empty() ? 0 : seqs[0].size();
+	switch(format) {
+	case FASTA:
+		for(size_t i = 0; i < names.size(); i++) {
+			out << ">" << names[i] << "\n";
+			for(size_t p = 0; p < length; p += width) { out << seqs[i].substr(p, width) << "\n"; }
+		}
+		break;
+	case MSF:
+		out << "PileUp\n\n MSF: " << length << " Type: P Check: 0 ..\n\n";
+		for(auto &n : names) { out << " Name: " << n << " Len: " << length << " Check: 0 Weight: 1.0\n"; }
+		out << "\n//\n";
+		for(size_t p = 0; p < length; p += width) {
+			out << "\n";
+			for(size_t i = 0; i < names.size(); i++) { out << names[i] << " " << seqs[i].substr(p, width) << "\n"; }
+		}
+		break;
+	case Phylip:
+		out << names.size() << " " << length << "\n";
+		for(size_t i = 0; i < names.size(); i++) { out << names[i] << " " << seqs[i] << "\n"; }
+		break;
+	case Interleaved:
+		out << names.size() << " " << length << "\n";
+		for(size_t i = 0; i < names.size(); i++) {
+			out << names[i] << "\n";
+			for(size_t p = 0; p < length; p += width) { out << seqs[i].substr(p, width) << "\n"; }
+		}
+		break;
+	}
+	if(!out.good()) { throw CError("Error writing '" + file + "'.\n"); }
+}
@@ -0,0 +1,38 @@
+/*
+ * Generator.h
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Synthetic test/reference MSA pairs for benchmarking
+ *	---
+ *	A random alignment of nSeq rows and length columns is drawn with each cell a gap with probability gaps. The reference
+ *	keeps a contiguous fragment of refFraction of each row's residues in the same columns, the rest becoming gaps. The test
+ *	holds every residue of each row with inserted gap columns added at random positions in each row, so the rows move
+ *	against each other and the test disagrees with the reference in places. Every reference fragment is therefore a subset
+ *	of the matching test sequence, as the scorer expects.
+ */
+
+#ifndef GENERATOR_H_
+#define GENERATOR_H_
+#include "Sequence.h"
+
+struct SGenParams {
+	int nSeq = 100;				// Number of sequences
+	int length = 1000;			// Number of columns in the reference
+	double gaps = 0.2;			// Probability a cell is a gap
+	double refFraction = 0.5;	// Fraction of each sequence's residues kept in the reference
+	int inserted = 50;			// Gap columns added to each test row
+	unsigned seed = 1;
+};
+
+struct SGenMSA {
+	std::vector <std::string> names;
+	std::vector <std::string> test;
+	std::vector <std::string> ref;
+};
+
+SGenMSA GenerateMSA(const SGenParams &params);
+std::string FileExtension(EFileType format);		// fas, msf, phy or int
+void WriteMSA(const std::string &file, EFileType format, const std::vector <std::string> &names, const std::vector <std::string> &seqs);
+
+#endif /* GENERATOR_H_ */
@@ -0,0 +1,101 @@
+/*
+ * KernelBench.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Microbenchmark for the pair counting kernels in Kernels.cpp against the original MakePairs/CountTP path they replace,
+ *	which is kept here as the baseline.
+ *	For each alignment length it times one pair comparison with every kernel the CPU supports and reports ns per pair
+ *	and the speedup over the pair vector path. Every kernel is checked against the scalar counts first.
+ *
+ *	Usage: kernelbench [length ...]
+ */
+
+#include "Kernels.h"
+#include "Scorer.h"
+#include <chrono>
+#include <iomanip>
+#include <random>
+
+using namespace::std;
+
+// The original pair vector path. Returns the pairs in strict ordering
+static vector <tuple<int,int>> MakePairs(vector<int> &x,vector<int> &y) {
+	vector <tuple<int,int> > retPairs;
+	assert(x.size() == y.size());
+	for(size_t i = 0 ; i < x.size(); i++) {
+		if(x[i] < 0 || y[i] < 0) { continue; }
+		retPairs.push_back(tuple<int,int>(x[i],y[i]));
+	}
+	return retPairs;
+}
+// Simply count the number where the tuples match
+static int CountTP(vector <tuple<int,int> > &x) {
+	int count = 0;
+	for(auto &p : x) { if(get<0>(p) == get<1>(p)) { count++; } }
+	return count;
+}
+
+// Label arrays that look like a real pair: ~30% of columns outside the reference, and the rest mostly agreeing.
+// The reference rows are ~30% gaps, as bit masks for the kernels and as the +/- labels MapPositions gives for MakePairs
+static void MakeLabels(int n, mt19937 &rng, vector <int> &x, vector <int> &y, vector <uint64_t> &mx, vector <uint64_t> &my, vector <int> &rx, vector <int> &ry) {
+	uniform_real_distribution<double> u(0.0,1.0);
+	x.assign(n,-BIG_NUMBER); y.assign(n,-BIG_NUMBER); mx.assign((n + 63) / 64,0); my.assign((n + 63) / 64,0); rx.assign(n,0); ry.assign(n,0);
+	for(int i = 0; i < n; i++) {
+		if(u(rng) > 0.3) { x[i] = i + 1; }
+		if(u(rng) > 0.3) { y[i] = u(rng) > 0.2 ? i + 1 : i + 2; }
+		bool gx = u(rng) < 0.3, gy = u(rng) < 0.3;
+		if(!gx) { mx[i / 64] |= (uint64_t)1 << (i % 64); }
+		if(!gy) { my[i / 64] |= (uint64_t)1 << (i % 64); }
+		rx[i] = gy ? -(i + 1) : i + 1; ry[i] = gx ? -(i + 1) : i + 1;
+	}
+}
+
+// Runs f until at least minTime has passed and returns nanoseconds per call
+template <class TFunc> double TimeCall(TFunc f) {
+	const double minTime = 0.2;
+	long long reps = 0, batch = 1;
+	auto start = chrono::steady_clock::now();
+	double elapsed = 0;
+	while(elapsed < minTime) {
+		for(long long r = 0; r < batch; r++) { f(); }
+		reps += batch; batch *= 2;
+		elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	}
+	return 1e9 * elapsed / reps;
+}
+
+int main(int argc, char *argv[]) {
+	vector <int> lengths = { 64, 256, 1024, 4096, 16384, 65536 };
+	if(argc > 1) { lengths.clear(); for(int i = 1; i < argc; i++) { lengths.push_back(atoi(argv[i])); } }
+	mt19937 rng(7);
+	volatile long long sink = 0;
+	int width = 12;
+	cout << left << setw(width) << "#length" << setw(width) << "kernel" << setw(width) << "ns/pair" << setw(width) << "speedup" << "\n";
+	for(int n : lengths) {
+		vector <int> x, y, rx, ry; vector <uint64_t> mx, my;
+		MakeLabels(n, rng, x, y, mx, my, rx, ry);
+		int words = mx.size();
+		// The pair vector path: MakePairs and CountTP on the test labels, plus MakePairs on the reference labels
+		double base = TimeCall([&]() {
+			vector <tuple<int,int> > testPairs = MakePairs(x, y), refPairs = MakePairs(rx, ry);
+			sink += CountTP(testPairs) + testPairs.size() + refPairs.size();
+		});
+		cout << setw(width) << n << setw(width) << "pairvector" << setw(width) << fixed << setprecision(1) << base << setw(width) << 1.0 << "\n";
+		const SPairKernel &scalar = PairKernels().front();
+		SLabelCounts expect = scalar.labels(x.data(), y.data(), n);
+		long long expectCommon = scalar.common(mx.data(), my.data(), words);
+		for(auto &k : PairKernels()) {
+			SLabelCounts got = k.labels(x.data(), y.data(), n);
+			if(got.both != expect.both || got.same != expect.same || k.common(mx.data(), my.data(), words) != expectCommon) {
+				cout << "\nError: kernel " << k.name << " disagrees with the scalar kernel at length " << n << "\n"; exit(-1);
+			}
+			double t = TimeCall([&]() {
+				SLabelCounts c = k.labels(x.data(), y.data(), n);
+				sink += c.both + c.same + k.common(mx.data(), my.data(), words);
+			});
+			cout << setw(width) << n << setw(width) << k.name << setw(width) << t << setw(width) << base / t << "\n";
+		}
+	}
+	return 0;
+}
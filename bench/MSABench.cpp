@@ -0,0 +1,111 @@
+/*
+ * MSABench.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Benchmark sweep over synthetic MSAs (see Generator.h). For each size and file format a test/reference pair is written
+ *	to a temporary directory and scored, timing separately:
+ *		parse : reading both files (ReadAlignment)
+ *		map   : matching and checking them and building the reference index and the alignment store, which maps every test sequence
+ *		        onto its reference fragment
+ *		pairs : the pairwise phase (ScorePairs)
+ *		columns : the column engine (ScoreColumns), for comparison
+ *	Each phase reports the best of reps runs in seconds. The output is one tab separated row per size and format, with the
+ *	column names on the first line, so runs from different releases can be compared directly.
+ *
+ *	Usage: msabench [-t N] [-reps R] [-gaps P] [-ref F] [-format fasta|msf|phylip|interleaved|all] [NxLength ...]
+ */
+
+#include "Generator.h"
+#include "Scorer.h"
+#include "Parallel.h"
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+using namespace::std;
+
+// Seconds taken by f
+template <class TFunc> double Seconds(TFunc f) {
+	auto start = chrono::steady_clock::now();
+	f();
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char *argv[]) {
+	vector <string> sizes;
+	string format = "all";
+	int threads = 1, reps = 3;
+	SGenParams params;
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-t") == 0 && i + 1 < argc) { threads = atoi(argv[++i]); }
+		else if(strcmp(argv[i], "-reps") == 0 && i + 1 < argc) { reps = atoi(argv[++i]); }
+		else if(strcmp(argv[i], "-gaps") == 0 && i + 1 < argc) { params.gaps = atof(argv[++i]); }
+		else if(strcmp(argv[i], "-ref") == 0 && i + 1 < argc) { params.refFraction = atof(argv[++i]); }
+		else if(strcmp(argv[i], "-format") == 0 && i + 1 < argc) { format = argv[++i]; }
+		else { sizes.push_back(argv[i]); }
+	}
+	reps = my_max(1, reps);
+	if(sizes.empty()) { sizes = { "100x1000", "400x1000", "1600x1000", "400x4000", "400x16000" }; }
+	threads = ThreadCount(threads);
+	char dirTemplate[] = "/tmp/msabench.XXXXXX";
+	if(mkdtemp(dirTemplate) == NULL) { cerr << "\nError: cannot create a temporary directory\n"; exit(-1); }
+	string dir = dirTemplate;
+	auto removeFiles = [&]() {
+		for(EFileType f : { FASTA, MSF, Phylip, Interleaved }) {
+			unlink((dir + "/test." + FileExtension(f)).c_str());
+			unlink((dir + "/ref." + FileExtension(f)).c_str());
+		}
+		rmdir(dir.c_str());
+	};
+	cout << "format\tnseq\tlength\tgaps\tref\tthreads\tbytes\tparse\tmap\tpairs\tcolumns\tTP\ttotalRef\n";
+	try {
+		for(auto &size : sizes) {
+			size_t x = size.find('x');
+			if(x == string::npos) { throw CError("\nError: sizes are given as NxLength, not " + size + "\n"); }
+			params.nSeq = atoi(size.substr(0, x).c_str());
+			params.length = atoi(size.substr(x + 1).c_str());
+			params.inserted = my_max(1, params.length / 20);
+			SGenMSA msa = GenerateMSA(params);
+			for(EFileType f : { FASTA, MSF, Phylip, Interleaved }) {
+				string name = FileTypeName(f);
+				transform(name.begin(), name.end(), name.begin(), ::tolower);
+				if(format != "all" && format != name) { continue; }
+				string testFile = dir + "/test." + FileExtension(f), refFile = dir + "/ref." + FileExtension(f);
+				WriteMSA(testFile, f, msa.names, msa.test);
+				WriteMSA(refFile, f, msa.names, msa.ref);
+				struct stat info;
+				stat(testFile.c_str(), &info);
+				double parse = 1e30, map = 1e30, pairs = 1e30, columns = 1e30;
+				SScore score;
+				for(int r = 0; r < reps; r++) {
+					unique_ptr <vector <CSequence> > test, ref;
+					unique_ptr <CRefIndex> index;
+					unique_ptr <CAlignStore> store;
+					parse = min(parse, Seconds([&]() {
+						test.reset(ReadAlignment(testFile, threads));
+						ref.reset(ReadAlignment(refFile, threads));
+					}));
+					map = min(map, Seconds([&]() {
+						CheckLengths(*ref, "reference");
+						index.reset(new CRefIndex(*ref));
+						CheckMatched(*test, *index);
+						store.reset(new CAlignStore(*test, *index));
+					}));
+					pairs = min(pairs, Seconds([&]() { score = ScorePairs(*store, threads); }));
+					columns = min(columns, Seconds([&]() {
+						if(!(ScoreColumns(*store) == score)) { throw CError("\nError: pair and column engines give different scores\n"); }
+					}));
+				}
+				cout << name << "\t" << params.nSeq << "\t" << params.length << "\t" << params.gaps << "\t" << params.refFraction << "\t" << threads << "\t" << info.st_size;
+				cout << "\t" << parse << "\t" << map << "\t" << pairs << "\t" << columns << "\t" << score.TP << "\t" << score.totalRef << endl;
+			}
+		}
+	} catch(CError &e) {
+		cerr << e.what();
+		removeFiles();
+		return -1;
+	}
+	removeFiles();
+	return 0;
+}
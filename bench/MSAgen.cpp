@@ -0,0 +1,60 @@
+/*
+ * MSAgen.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Writes a synthetic test/reference MSA pair (see Generator.h) as Prefix_test.ext and Prefix_ref.ext in each format
+ *
+ *	Usage: msagen [-n N] [-l Length] [-gaps P] [-ref F] [-insert K] [-seed S] [-format fasta|msf|phylip|interleaved|all] Prefix
+ */
+
+#include "Generator.h"
+#include <cstring>
+
+using namespace::std;
+
+int main(int argc, char *argv[]) {
+	SGenParams params;
+	string prefix, format = "all";
+	for(int i = 1; i < argc; i++) {
+		if(strcmp(argv[i], "-n") == 0 && i + 1 < argc) { params.nSeq = atoi(argv[++i]); }
+		else if(strcmp(argv[i], "-l") == 0 && i + 1 < argc) { params.length = atoi(argv[++i]); }
+		else if(strcmp(argv[i], "-gaps") == 0 && i + 1 < argc) { params.gaps = atof(argv[++i]); }
+		else if(strcmp(argv[i], "-ref") == 0 && i + 1 < argc) { params.refFraction = atof(argv[++i]); }
+		else if(strcmp(argv[i], "-insert") == 0 && i + 1 < argc) { params.inserted = atoi(argv[++i]); }
+		else if(strcmp(argv[i], "-seed") == 0 && i + 1 < argc) { params.seed = atoi(argv[++i]); }
+		else if(strcmp(argv[i], "-format") == 0 && i + 1 < argc) { format = argv[++i]; }
+		else if(prefix.empty()) { prefix = argv[i]; }
+		else { cout << "\nError: unexpected argument " << argv[i] << "\n"; exit(-1); }
+	}
+	if(prefix.empty() || params.nSeq < 2 || params.length < 1 || !InRange(params.gaps, 0.0, 1.0) || params.refFraction <= 0 || params.refFraction > 1 || params.inserted < 0) {
+		cout << "\nUsage: msagen [-n N] [-l Length] [-gaps P] [-ref F] [-insert K] [-seed S] [-format fasta|msf|phylip|interleaved|all] Prefix";
+		cout << "\n\t-n N : number of sequences (default 100, at least 2)";
+		cout << "\n\t-l Length : number of columns in the reference (default 1000)";
+		cout << "\n\t-gaps P : probability each cell is a gap, 0 <= P < 1 (default 0.2)";
+		cout << "\n\t-ref F : fraction of each sequence's residues kept in the reference, 0 < F <= 1 (default 0.5)";
+		cout << "\n\t-insert K : gap columns inserted at random in each test row (default 50)";
+		cout << "\n\t-seed S : random seed (default 1)";
+		cout << "\n\t-format : format(s) to write (default all)";
+		cout << "\nWrites Prefix_test.ext and Prefix_ref.ext\n\n";
+		exit(-1);
+	}
+	vector <EFileType> formats;
+	for(EFileType f : { FASTA, MSF, Phylip, Interleaved }) {
+		string name = FileTypeName(f);
+		transform(name.begin(), name.end(), name.begin(), ::tolower);
+		if(format == "all" || format == name) { formats.push_back(f); }
+	}
+	if(formats.empty()) { cout << "\nError: unknown format " << format << "\n"; exit(-1); }
+	SGenMSA msa = GenerateMSA(params);
+	try {
+		for(EFileType f : formats) {
+			WriteMSA(prefix + "_test." + FileExtension(f), f, msa.names, msa.test);
+			WriteMSA(prefix + "_ref." + FileExtension(f), f, msa.names, msa.ref);
+		}
+	} catch(CError &e) {
+		cerr << e.what();
+		return -1;
+	}
+	return 0;
+}
@@ -0,0 +1,611 @@
+/*
+ * ScoreTest.cpp
+ *
+ *  Created on: 16 Oct 2026
+ *      ---
+ *	Self-checks run by make test. Synthetic test/reference MSA pairs from the msagen generator (bench/Generator.h) are
+ *	scored by the original program's scorer, copied below as it was (MapPositions with find, MakePairs and CountTP), and
+ *	by ScorePairs, ScorePairShard and ScoreColumns on the alignment store, which must all give the same totals. Some are
+ *	also written out in every format as msagen writes them and read back, or piped gzip compressed into stdin, which must
+ *	not change the totals either, and the parallel readers must read what the serial readers do. The pair shards must sum
+ *	to ScorePairs however many there are, and merging must refuse repeated or missing shards. A pair file read back must
+ *	hold the names and the ComparePairs counts of every pair. Random edits made with CIncrementalScorer must match
+ *	scoring the edited rows afresh, and ScoreMetrics must give SP and TC of 1 for an exact alignment, lose one column of
+ *	TC for one misplaced character, and agree with ScorePairs. SampleAlignment must be repeatable for a seed, exact when
+ *	asked for more precision than sampling can give, and its 95% intervals must hold the exact totals for most seeds.
+ *	Last, both pair paths must make no heap allocations per pair once warmed up (counted by Allocations.cpp, linked in
+ *	here).
+ *	Prints one line per check and exits non-zero if any fails.
+ *
+ *	Usage: scoretest
+ */
+
+#include "bench/Generator.h"
+#include "FileBuffer.h"
+#include "Incremental.h"
+#include "Library.h"
+#include "Metrics.h"
+#include "PairFile.h"
+#include "Parallel.h"
+#include "Profile.h"
+#include "Scorer.h"
+#include "Shard.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <unistd.h>
+#include <zlib.h>
+
+using namespace::std;
+
+static int failures = 0;
+
+static void Expect(bool ok, const string &what) {
+	cout << (ok ? "ok      " : "FAILED  ") << what << "\n";
+	if(!ok) { failures++; }
+}
+
+static string ScoreText(const SScore &score) {
+	return to_string(score.TP) + "/" + to_string(score.FP) + "/" + to_string(score.FN) + "/" + to_string(score.totalRef);
+}
+
+// The rows of a generated pair as the scorer reads them, named and in the same order on both sides
+static vector <CSequence> Rows(const vector <string> &names, const vector <string> &seqs) {
+	vector <CSequence> retSeq;
+	for(size_t i = 0; i < names.size(); i++) { retSeq.push_back(CSequence(names[i], seqs[i])); }
+	return retSeq;
+}
+
+// The scorer of the original program, kept as it was (only the casts needed to build without warnings are added) so the
+// library is checked against something that shares none of its code
+namespace baseline {
+
+string RemoveGaps(string &seq);
+tuple<vector<int>,vector<int>> MapPositions(string &x, string &y, string &z); // Maps x to y, with -1 for cases where x doesn't occur in y; uses the second reference sequence z to ignore gaps
+vector <tuple<int,int>> MakePairs(vector<int> &x,vector<int> &y);
+int CountTP(vector <tuple<int,int> > &x);
+SScore ComparePairs(tuple<string, string> s1, tuple<string, string> s2); // Compare sequences s1/s2 with <test,ref> for each
+
+inline bool IsGap(char c) {
+	std::string gaps = ".*-X?";
+	if(std::find(gaps.begin(),gaps.end(),c) != gaps.end()) { return true; }
+	return false;
+}
+
+string RemoveGaps(string &seq) {
+	stringstream retSeq;
+	for(int i = 0 ; i < (int)seq.size(); i++) {
+		if(!IsGap(seq[i])) {
+			retSeq << seq[i];
+		}
+	}
+	return retSeq.str();
+}
+
+// Map the reference sequence y onto the test sequence x. Uses the second reference sequence z to ensure gaps are handled correctly
+tuple<vector<int>,vector<int>> MapPositions(string &x, string &y, string &z) {
+	string x_clean = RemoveGaps(x);	// The raw sequences unaligned
+	string y_clean = RemoveGaps(y);
+	assert(y.size() == z.size());	// Check the aligned reference is correct
+	vector <int> y_clean_int(y_clean.size(),-BIG_NUMBER);	// Storage of character mapping
+	vector <int> x_int(x.size(),-BIG_NUMBER), y_int(y.size(),-BIG_NUMBER);		// The return vectors
+	int start_x = (int) x_clean.find(y_clean);	// Get the real character position that y starts in clean_x, recast as int
+	int end_x = start_x + y_clean.size();		// Get the positon in clean_x where y is expected to end
+	if(start_x == (int)string::npos) { cout << "\nError: reference sequence is not a valid subset of the test sequence\ntest: " << x << "\nref:  " << y; exit(-1); }
+	// Create the map for reference (y) based on the other reference (z)
+	int pos = 0;										// Sequence position number (observable character)
+	for(int i = 0; i < (int)y.size(); i++) {
+		if(IsGap(z[i])) { y_int[i] = -(i + 1); }				// If aligned to a gap => label as -int
+		else { y_int[i] = i + 1; }							// If aligned to a character => label as int
+		if(!IsGap(y[i])) { y_clean_int[pos++] = i + 1; }    // Transfer that number to y_clean_int for mapping to x
+	}
+	// Now build the x_int
+	pos = 0;											// Sequence position number (observable character)
+	for(int i = 0; i < (int)x.size(); i++) {
+		if(IsGap(x[i])) { continue; }							// Don't care about gaps
+		if(pos < start_x || pos >= end_x) { pos++; continue; }	// If the observable character in x is not also in y, just skip
+		x_int[i] = y_clean_int[pos++ - start_x];				// Otherwise add the label from y_clean_int to x_int
+	}
+	return tuple<vector<int>,vector<int>>(x_int,y_int);
+}
+
+// Returns the pairs in strict ordering
+vector <tuple<int,int>> MakePairs(vector<int> &x,vector<int> &y) {
+	vector <tuple<int,int> > retPairs;
+	assert(x.size() == y.size());
+	for(int i = 0 ; i < (int)x.size(); i++) {
+		if(x[i] < 0 || y[i] < 0) { continue; }
+		retPairs.push_back(tuple<int,int>(x[i],y[i]));
+	}
+	return retPairs;
+}
+
+// Simply count the number where the tuples match
+int CountTP(vector <tuple<int,int> > &x) {
+	int count = 0;
+	for(auto &p : x) { if(get<0>(p) == get<1>(p)) { count++; } }
+	return count;
+}
+
+// Compare the pairs x and y <0: test, 1: ref> and return the score
+SScore ComparePairs(tuple<string, string> seq1, tuple<string, string> seq2) {
+	SScore retScore;
+	// Get labels for each of the sequences so we can identify and compare homology pairs; Detailed in the function
+	tuple<vector<int>,vector<int>> s1_int = MapPositions(get<0>(seq1),get<1>(seq1),get<1>(seq2));
+	tuple<vector<int>,vector<int>> s2_int = MapPositions(get<0>(seq2),get<1>(seq2),get<1>(seq1));
+	// From these labels construct all of the pairs where both characters are present in the reference (defined as both labels >= 0)
+	vector <tuple<int,int> > testPairs = MakePairs(get<0>(s1_int),get<0>(s2_int));
+	vector <tuple<int,int> > refPairs = MakePairs(get<1>(s1_int),get<1>(s2_int));
+	// Transfer information to the score structure
+	retScore.totalTest = testPairs.size();
+	retScore.totalRef = refPairs.size();
+	retScore.TP = CountTP(testPairs);					// Intersection of totalTest and totalRef, but can be computed more simply
+	retScore.FN = retScore.totalRef - retScore.TP;		// FNs are the
+	retScore.FP = testPairs.size() - retScore.TP;		// FPs are the size of testPairs that are not TP
+	assert(retScore.FN >= 0);
+	return retScore;
+}
+
+}
+
+// Sum of the original ComparePairs over every pair, as the original main did it
+static SScore ScoreLegacy(const SGenMSA &msa) {
+	SScore retScore;
+	for(size_t i = 0; i < msa.test.size(); i++) {
+		for(size_t j = i + 1; j < msa.test.size(); j++) {
+			retScore += baseline::ComparePairs(tuple<string,string>(msa.test[i],msa.ref[i]),tuple<string,string>(msa.test[j],msa.ref[j]));
+		}
+	}
+	return retScore;
+}
+
+static void CrossCheck(const SGenParams &params, const string &name) {
+	SGenMSA msa = GenerateMSA(params);
+	vector <CSequence> test = Rows(msa.names, msa.test), ref = Rows(msa.names, msa.ref);
+	CRefIndex index(ref);
+	CAlignStore store(test, index);
+	SScore legacy = ScoreLegacy(msa), pairs = ScorePairs(store, 1), threaded = ScorePairs(store, 3), columns = ScoreColumns(store), tiles;
+	for(int shard = 0; shard < 3; shard++) { tiles += ScorePairShard(store, shard, 3, 2); }
+	Expect(legacy == pairs && legacy == threaded && legacy == tiles && legacy == columns, name + ": legacy " + ScoreText(legacy) + ", pairs " + ScoreText(pairs)
+			+ ", 3 threads " + ScoreText(threaded) + ", 3 shards of tiles " + ScoreText(tiles) + ", columns " + ScoreText(columns));
+}
+
+// The pair written in format to dir, read back and scored as msascorer does
+static void FileCheck(const SGenParams &params, EFileType format, const string &dir) {
+	SGenMSA msa = GenerateMSA(params);
+	string prefix = dir + "/gen" + to_string(params.seed) + ".";
+	WriteMSA(prefix + "test." + FileExtension(format), format, msa.names, msa.test);
+	WriteMSA(prefix + "ref." + FileExtension(format), format, msa.names, msa.ref);
+	unique_ptr <vector <CSequence> > test(ReadAlignment(prefix + "test." + FileExtension(format), 1));
+	unique_ptr <vector <CSequence> > ref(ReadAlignment(prefix + "ref." + FileExtension(format), 1));
+	unlink((prefix + "test." + FileExtension(format)).c_str());
+	unlink((prefix + "ref." + FileExtension(format)).c_str());
+	CRefIndex index(*ref);
+	CheckMatched(*test, index);
+	CAlignStore store(*test, index);
+	SScore legacy = ScoreLegacy(msa), pairs = ScorePairs(store, 1);
+	Expect(legacy == pairs, FileTypeName(format) + " files, seed=" + to_string(params.seed) + ": legacy " + ScoreText(legacy) + ", read back " + ScoreText(pairs));
+}
+
+// The generated test rows written by hand in format with eol line ends and, between lines where the format allows them,
+// '#' comment lines and, if blanks, blank lines. FASTA only has comments before the first record and blank lines after
+// the names, as anywhere else they would be sequence or throw the sequence away. Sequence lines are 60 characters
+static string FormatText(const SGenMSA &msa, EFileType format, const string &eol, bool blanks, mt19937 &rng) {
+	auto extra = [&](bool comments) {
+		string lines;
+		while(rng() % 3 == 0) {
+			bool comment = rng() % 2;
+			if(comment ? comments : blanks) { lines += comment ? "# a comment" + eol : eol; }
+		}
+		return lines;
+	};
+	const size_t width = 60;
+	size_t length = msa.test[0].size();
+	string retText;
+	if(format == FASTA) {
+		retText += "# made by scoretest" + eol;
+		for(size_t i = 0; i < msa.test.size(); i++) {
+			retText += ">" + msa.names[i] + eol + extra(false);
+			for(size_t c = 0; c < length; c += width) { retText += msa.test[i].substr(c, width) + eol; }
+		}
+	} else if(format == Phylip) {
+		retText += extra(true) + to_string(msa.test.size()) + " " + to_string(length) + eol;
+		for(size_t c = 0; c < length; c += width) {
+			retText += extra(true);
+			for(size_t i = 0; i < msa.test.size(); i++) { retText += (c == 0 ? msa.names[i] + "  " : "") + msa.test[i].substr(c, width) + eol; }
+		}
+	} else {
+		retText += extra(true) + to_string(msa.test.size()) + " " + to_string(length) + eol;
+		for(size_t i = 0; i < msa.test.size(); i++) {
+			retText += extra(true) + msa.names[i] + eol;
+			for(size_t c = 0; c < length; c += width) { retText += extra(true) + msa.test[i].substr(c, width) + eol; }
+		}
+	}
+	return retText;
+}
+
+// The sequences read, one name and row per line, or the error
+static string ReadOutcome(const function<vector <CSequence> *()> &read) {
+	string retText;
+	try {
+		unique_ptr <vector <CSequence> > seqs(read());
+		for(auto &s : *seqs) { retText += s.Name() + " " + s.RawSeq() + "\n"; }
+	} catch(CError &e) { retText = string("error: ") + e.what(); }
+	return retText;
+}
+
+// Each parallel reader against its serial reader, with chunks small enough that a small file is split between the threads.
+// With CRLF line ends a blank line is not empty, which the Phylip and Interleaved readers do not expect, and both readers
+// must then fail the same way
+static void ParallelReadCheck(const SGenParams &params, const string &dir) {
+	SGenMSA msa = GenerateMSA(params);
+	mt19937 rng(params.seed);
+	string file = dir + "/parallel.txt";
+	for(EFileType format : { FASTA, Phylip, Interleaved }) {
+		for(int variant = 0; variant < 3; variant++) {
+			string eol = variant == 0 ? "\n" : "\r\n";
+			bool blanks = variant != 1;
+			{	ofstream out(file.c_str(), ofstream::binary);
+				out << FormatText(msa, format, eol, blanks, rng);
+			}
+			CFileBuffer buffer(file);
+			string serial = ReadOutcome([&]() {
+				CBufferStream input(buffer.Data(), buffer.Size());
+				return format == FASTA ? FASTAReader(input) : format == Phylip ? PhylipReader(input, file) : InterleavedReader(input, file);
+			});
+			for(int threads : { 2, 5 }) {
+				string parallel = ReadOutcome([&]() {
+					const size_t chunkBytes = 1024;
+					return format == FASTA ? ParallelFASTAReader(buffer, threads, chunkBytes) : format == Phylip ? ParallelPhylipReader(buffer, file, threads, chunkBytes)
+							: ParallelInterleavedReader(buffer, file, threads, chunkBytes);
+				});
+				Expect(parallel == serial, "parallel " + FileTypeName(format) + (eol == "\n" ? "" : " CRLF") + (blanks ? " with blank lines" : "") + ", " + to_string(threads) + " threads, "
+						+ to_string(buffer.Size()) + " bytes: " + (parallel == serial ? "" : "not ") + "the same as the serial reader"
+						+ (serial.compare(0, 6, "error:") == 0 ? " (both fail)" : ""));
+			}
+		}
+	}
+	unlink(file.c_str());
+}
+
+// The shards of the pairs must sum to ScorePairs for any number of shards, including more shards than there are tiles, in
+// which case some are empty. Written out and merged they must give the same totals, and merging must refuse a shard given
+// twice or one left out
+static void ShardCheck(SGenParams params, const string &dir) {
+	params.nSeq = 100;		// Ten tiles
+	SGenMSA msa = GenerateMSA(params);
+	vector <CSequence> test = Rows(msa.names, msa.test), ref = Rows(msa.names, msa.ref);
+	CRefIndex index(ref);
+	CAlignStore store(test, index);
+	SScore pairs = ScorePairs(store);
+	for(int shards : { 1, 2, 3, 7, 20, 100 }) {
+		SScore sum;
+		for(int shard = 0; shard < shards; shard++) { sum += ScorePairShard(store, shard, shards, 2); }
+		Expect(sum == pairs, to_string(shards) + " shards of " + to_string(MakeTiles(store.Size(), 32).size()) + " tiles: sum " + ScoreText(sum) + ", pairs " + ScoreText(pairs));
+	}
+	const int shards = 3;
+	vector <string> files;
+	for(int shard = 0; shard < shards; shard++) {
+		SShard partial;
+		partial.shard = shard;
+		partial.shards = shards;
+		partial.test = ShardInput("test", test);
+		partial.ref = ShardInput("ref", ref);
+		partial.gaps = LEGACY_GAPS;
+		partial.score = ScorePairShard(store, shard, shards);
+		files.push_back(dir + "/shard" + to_string(shard + 1) + ".json");
+		WriteShard(files.back(), partial);
+	}
+	SShard merged = MergeShards(files);
+	Expect(merged.score == pairs, "merged shards: " + ScoreText(merged.score) + ", pairs " + ScoreText(pairs));
+	for(auto &bad : { vector <string> { files[0], files[1], files[1], files[2] }, vector <string> { files[0], files[2] } }) {
+		string error;
+		try { MergeShards(bad); }
+		catch(CError &e) { error = e.what(); }
+		Expect(!error.empty(), string(bad.size() > (size_t)shards ? "a repeated" : "a missing") + " shard is refused: " + (error.empty() ? "no error" : error.substr(1, error.find('\n', 1) - 1)));
+	}
+	for(auto &f : files) { unlink(f.c_str()); }
+}
+
+// ScoreMetrics on the reference scored against itself, where SP and TC are 1; with one character of a reference column
+// moved to a column of its own, where TC loses exactly one column; and on a generated pair, where the pair totals and the
+// per-column counts must be those of ScorePairs
+static void MetricsCheck(const SGenParams &params) {
+	SGenMSA msa = GenerateMSA(params);
+	vector <CSequence> ref = Rows(msa.names, msa.ref);
+	CRefIndex index(ref);
+	vector <CSequence> same = ref;
+	CAlignStore sameStore(same, index);
+	SMetrics identical = ScoreMetrics(sameStore);
+	Expect(identical.SP() == 1 && identical.TC() == 1 && identical.refColumns > 0, "metrics of the reference against itself: SP " + to_string(identical.SP())
+			+ ", TC " + to_string(identical.TC()) + " of " + to_string(identical.refColumns) + " columns");
+	// A gap column after column c, and the character of row r in column c moved into it
+	int c = -1, r = -1;
+	for(int k = 0; k < index.Length() && c < 0; k++) {
+		int chars = 0, last = -1;
+		for(int i = 0; i < index.Size(); i++) { if(!SAlphabet().IsGap(msa.ref[i][k])) { chars++; last = i; } }
+		if(chars >= 2) { c = k; r = last; }
+	}
+	vector <string> rows = msa.ref;
+	for(auto &row : rows) { row.insert(c + 1, "-"); }
+	swap(rows[r][c], rows[r][c + 1]);
+	vector <CSequence> moved = Rows(msa.names, rows);
+	CAlignStore movedStore(moved, index);
+	SMetrics split = ScoreMetrics(movedStore);
+	Expect(split.refColumns == identical.refColumns && split.correctColumns == identical.correctColumns - 1 && fabs(identical.TC() - split.TC() - 1.0 / identical.refColumns) < 1e-12,
+			"metrics with column " + to_string(c + 1) + " split: TC " + to_string(split.TC()) + ", " + to_string(split.correctColumns) + " of " + to_string(split.refColumns) + " columns");
+	vector <CSequence> test = Rows(msa.names, msa.test);
+	CAlignStore store(test, index);
+	SMetrics metrics = ScoreMetrics(store);
+	SScore pairs = ScorePairs(store), columns;
+	for(size_t k = 0; k < metrics.columnChars.size(); k++) {
+		columns.TP += metrics.columnTP[k];
+		columns.totalRef += (long long)metrics.columnChars[k] * (metrics.columnChars[k] - 1) / 2;
+	}
+	Expect(metrics.score == pairs && columns.TP == pairs.TP && columns.totalRef == pairs.totalRef, "metrics totals " + ScoreText(metrics.score) + ", pairs "
+			+ ScoreText(pairs) + ", per column TP " + to_string(columns.TP) + " of " + to_string(columns.totalRef));
+}
+
+// SampleAlignment on a deep alignment. A seed must give the same estimate every time and on any number of threads; a
+// precision too fine to reach by sampling must compare every pair and give ScorePairs exactly; and the exact totals must
+// be inside each total's 95% interval for at least 90% of the seeds tried
+static void SamplingCheck(SGenParams params) {
+	params.nSeq = 300;
+	SGenMSA msa = GenerateMSA(params);
+	vector <CSequence> ref = Rows(msa.names, msa.ref);
+	CScoringReference reference(move(ref));
+	auto sample = [&](double precision, unsigned long long seed, int threads) {
+		SSampleOptions options;
+		options.precision = precision;
+		options.seed = seed;
+		options.threads = threads;
+		return SampleAlignment(Rows(msa.names, msa.test), reference, options);
+	};
+	vector <CSequence> test = Rows(msa.names, msa.test);
+	CheckMatched(test, reference.Index());
+	CAlignStore store(test, reference.Index());
+	SScore pairs = ScorePairs(store);
+	SSampledScore first = sample(0.01, 7, 1), again = sample(0.01, 7, 1), threaded = sample(0.01, 7, 3);
+	Expect(!first.exact && first.score == again.score && first.halfWidth == again.halfWidth && first.sampled == again.sampled
+			&& first.score == threaded.score && first.sampled == threaded.sampled, "sampling with seed 7: " + ScoreText(first.score) + " from "
+			+ to_string(first.sampled) + " of " + to_string(first.pairs) + " pairs, again " + ScoreText(again.score) + ", on 3 threads " + ScoreText(threaded.score));
+	SSampledScore exact = sample(1e-9, 7, 2);
+	Expect(exact.exact && exact.score == pairs && exact.halfWidth == SScore() && exact.sampled == exact.pairs, "sampling to 1e-9: "
+			+ ScoreText(exact.score) + (exact.exact ? ", exact" : ", not exact") + ", pairs " + ScoreText(pairs));
+	auto inside = [](long long estimate, long long halfWidth, long long value) { return value >= estimate - halfWidth && value <= estimate + halfWidth; };
+	int seeds = 100, covered[4] = { 0, 0, 0, 0 };
+	for(int seed = 1; seed <= seeds; seed++) {
+		SSampledScore estimate = sample(0.01, seed, 1);
+		covered[0] += inside(estimate.score.TP, estimate.halfWidth.TP, pairs.TP);
+		covered[1] += inside(estimate.score.FP, estimate.halfWidth.FP, pairs.FP);
+		covered[2] += inside(estimate.score.FN, estimate.halfWidth.FN, pairs.FN);
+		covered[3] += inside(estimate.score.totalRef, estimate.halfWidth.totalRef, pairs.totalRef);
+	}
+	int fewest = *min_element(covered, covered + 4);
+	Expect(fewest * 10 >= seeds * 9, "sampling intervals hold the exact TP/FP/FN/totalRef for " + to_string(covered[0]) + "/" + to_string(covered[1]) + "/"
+			+ to_string(covered[2]) + "/" + to_string(covered[3]) + " of " + to_string(seeds) + " seeds");
+}
+
+// The pair file written by ScorePairs on several threads, read back with CPairReader: the names must be the reference's in
+// order, and every pair, looked up either way round or by row, must hold the counts of ComparePairs on the store
+static void PairFileCheck(SGenParams params, const string &dir) {
+	params.nSeq = 70;		// Tiles of differing sizes
+	SGenMSA msa = GenerateMSA(params);
+	vector <CSequence> test = Rows(msa.names, msa.test), ref = Rows(msa.names, msa.ref);
+	CRefIndex index(ref);
+	CAlignStore store(test, index);
+	string file = dir + "/pairs.bin";
+	vector <string> names;
+	for(int i = 0; i < index.Size(); i++) { names.push_back(index.Name(i)); }
+	SScore total;
+	{	CPairWriter writer(file, names);
+		total = ScorePairs(store, 3, nullptr, &writer);
+	}
+	CPairReader reader(file);
+	bool namesOk = reader.Size() == index.Size();
+	for(int i = 0; namesOk && i < reader.Size(); i++) { namesOk = reader.Name(i) == index.Name(i) && reader.Find(index.Name(i)) == i; }
+	long long wrong = 0, pairs = 0;
+	SScore sum;
+	vector <SPairRecord> row;
+	auto same = [](const SPairRecord &r, const SScore &score) { return r.TP == score.TP && r.FP == score.FP && r.FN == score.FN && r.totalRef == score.totalRef; };
+	for(int i = 0; i < reader.Size(); i++) {
+		reader.Row(i, row);
+		for(int j = 0; j < reader.Size(); j++) {
+			if(j == i) { continue; }
+			SScore score = ComparePairs(store, my_min(i, j), my_max(i, j));
+			if(!same(reader.Pair(i, j), score) || !same(row[j], score)) { wrong++; }
+			if(i < j) {
+				pairs++;
+				sum.TP += reader.Pair(i, j).TP; sum.FP += reader.Pair(i, j).FP; sum.FN += reader.Pair(i, j).FN; sum.totalRef += reader.Pair(i, j).totalRef;
+			}
+		}
+	}
+	unlink(file.c_str());
+	sum.totalTest = sum.TP + sum.FP;
+	Expect(namesOk && wrong == 0 && sum == total, "pair file: names " + string(namesOk ? "match" : "differ") + ", " + to_string(wrong) + " lookups of "
+			+ to_string(pairs) + " pairs differ from ComparePairs, records sum to " + ScoreText(sum) + ", pairs " + ScoreText(total));
+}
+
+// The test file gzip compressed and piped into stdin, which can only be recognised as compressed once it has been read
+static void GzipStdinCheck(const SGenParams &params, const string &dir) {
+	SGenMSA msa = GenerateMSA(params);
+	string file = dir + "/stdin.fa";
+	WriteMSA(file, FASTA, msa.names, msa.test);
+	string compressed;
+	{	ifstream input(file.c_str(), ifstream::binary);
+		string text((istreambuf_iterator<char>(input)), istreambuf_iterator<char>());
+		gzFile gz = gzopen((file + ".gz").c_str(), "wb");
+		gzwrite(gz, text.data(), text.size());
+		gzclose(gz);
+		ifstream packed((file + ".gz").c_str(), ifstream::binary);
+		compressed.assign(istreambuf_iterator<char>(packed), istreambuf_iterator<char>());
+	}
+	unlink(file.c_str());
+	unlink((file + ".gz").c_str());
+	int ends[2];
+	if(pipe(ends) != 0) { throw CError("\nError: cannot make a pipe\n"); }
+	int savedStdin = dup(STDIN_FILENO);
+	dup2(ends[0], STDIN_FILENO);
+	close(ends[0]);
+	thread writer([&]() {
+		for(size_t done = 0; done < compressed.size(); ) {
+			ssize_t put = write(ends[1], compressed.data() + done, compressed.size() - done);
+			if(put <= 0) { break; }
+			done += put;
+		}
+		close(ends[1]);
+	});
+	unique_ptr <vector <CSequence> > test;
+	try { test.reset(ReadAlignment("-", 1)); }
+	catch(CError &) { writer.join(); dup2(savedStdin, STDIN_FILENO); close(savedStdin); throw; }
+	writer.join();
+	dup2(savedStdin, STDIN_FILENO);
+	close(savedStdin);
+	vector <CSequence> ref = Rows(msa.names, msa.ref);
+	CRefIndex index(ref);
+	CheckMatched(*test, index);
+	CAlignStore store(*test, index);
+	SScore legacy = ScoreLegacy(msa), piped = ScorePairs(store, 1);
+	Expect(legacy == piped, "gzip FASTA on stdin, " + to_string(compressed.size()) + " bytes: legacy " + ScoreText(legacy) + ", read back " + ScoreText(piped));
+}
+
+// Moves the gaps of row[a,b] to random places, keeping its residues in order
+static void ShuffleGaps(string &row, int a, int b, mt19937 &rng) {
+	string residues = RemoveGaps(row.substr(a, b - a + 1));
+	vector <bool> gap(b - a + 1, false);
+	fill(gap.begin() + residues.size(), gap.end(), true);
+	shuffle(gap.begin(), gap.end(), rng);
+	for(int c = a, r = 0; c <= b; c++) { row[c] = gap[c - a] ? '-' : residues[r++]; }
+}
+
+// Random edits made through CIncrementalScorer, each checked against scoring its rows from scratch. The edits move gaps,
+// change residues outside the reference fragments, or change one inside a fragment, which should fail. An edit that fails
+// must leave the rows and the score as they were, however many other rows it changed
+static void IncrementalCheck(const SGenParams &params) {
+	SGenMSA msa = GenerateMSA(params);
+	vector <CSequence> test = Rows(msa.names, msa.test), ref = Rows(msa.names, msa.ref);
+	CRefIndex index(ref);
+	CIncrementalScorer scorer(test, index);
+	mt19937 rng(params.seed);
+	const string aminoAcids = AMINO_ACIDS;
+	int edits = 200, wrong = 0, rejected = 0;
+	vector <int> labels(scorer.Length());
+	for(int e = 0; e < edits; e++) {
+		vector <string> rows;
+		for(int k = 0; k < scorer.Size(); k++) { rows.push_back(scorer.Row(k)); }
+		SScore score = scorer.Score();
+		bool threw = false;
+		try {
+			int k = rng() % scorer.Size();
+			if(e % 4 == 0) {
+				string row = scorer.Row(k);
+				ShuffleGaps(row, 0, row.size() - 1, rng);
+				scorer.ReplaceRow(k, row);
+			} else {
+				int width = 1 + rng() % 40, a = rng() % (scorer.Length() - width + 1), b = a + width - 1;
+				vector <string> block;
+				for(int r = 0; r < scorer.Size(); r++) {
+					block.push_back(scorer.Row(r).substr(a, width));
+					MapTestLabels(scorer.Row(r), index, r, labels.data());
+					int c = a + rng() % width;
+					bool inFragment = labels[c] >= 0, breaking = e % 4 == 3 && r == k;
+					switch(rng() % 3) {
+					case 0: ShuffleGaps(block[r], 0, width - 1, rng); break;
+					case 1:
+						if(!SAlphabet().IsGap(block[r][c - a]) && inFragment == breaking) {
+							block[r][c - a] = aminoAcids[(aminoAcids.find(block[r][c - a]) + 1 + rng() % 19) % 20];
+						}
+						break;
+					}
+				}
+				scorer.UpdateColumns(a, b, block);
+			}
+		} catch(CError &) { threw = true; rejected++; }
+		vector <CSequence> now;
+		for(int k = 0; k < scorer.Size(); k++) { now.push_back(CSequence(scorer.Name(k), scorer.Row(k))); }
+		CAlignStore rescored(now, index);
+		bool ok = ScorePairs(rescored) == scorer.Score();
+		if(threw) {
+			ok = ok && scorer.Score() == score;
+			for(int k = 0; k < scorer.Size(); k++) { ok = ok && scorer.Row(k) == rows[k]; }
+		}
+		if(!ok) { wrong++; }
+	}
+	Expect(wrong == 0 && rejected > 0, "incremental: " + to_string(wrong) + " of " + to_string(edits) + " random edits differ from a rescoring, "
+			+ to_string(rejected) + " rejected");
+}
+
+// Allocations made comparing every pair, after a first pass to warm up the per-thread buffers
+static void AllocationCheck(const SGenParams &params) {
+	SGenMSA msa = GenerateMSA(params);
+	vector <CSequence> test = Rows(msa.names, msa.test), ref = Rows(msa.names, msa.ref);
+	CRefIndex index(ref);
+	CAlignStore store(test, index);
+	vector <tuple <string, string> > rows;
+	for(size_t i = 0; i < msa.test.size(); i++) { rows.push_back(make_tuple(msa.test[i], msa.ref[i])); }
+	long long allocated = 0, pairs = 0;
+	for(int pass = 0; pass < 2; pass++) {		// The first pass grows the scratch buffers to the longest rows
+		allocated = threadAllocations;
+		pairs = 0;
+		for(size_t i = 0; i < rows.size(); i++) {
+			for(size_t j = i + 1; j < rows.size(); j++) { ComparePairs(rows[i], rows[j]); pairs++; }
+		}
+		allocated = threadAllocations - allocated;
+	}
+	Expect(allocated == 0, "tuple ComparePairs: " + to_string(allocated) + " allocations over " + to_string(pairs) + " pairs");
+	for(int threads : { 1, 3 }) {
+		long long allocations = -1;
+		ScorePairs(store, threads, &allocations);
+		Expect(allocations == 0, "ScorePairs, " + to_string(threads) + " threads: " + to_string(allocations) + " allocations over " + to_string(pairs) + " pairs");
+	}
+}
+
+int main() {
+	try {
+		SGenParams params;
+		params.length = 300;
+		for(unsigned seed = 1; seed <= 4; seed++) {
+			for(double gaps : { 0.0, 0.2, 0.6 }) {
+				for(double refFraction : { 0.3, 1.0 }) {
+					params.nSeq = 20 + 15 * seed;
+					params.gaps = gaps;
+					params.refFraction = refFraction;
+					params.inserted = seed == 4 ? 0 : 30;
+					params.seed = seed;
+					CrossCheck(params, "n=" + to_string(params.nSeq) + " gaps=" + to_string(gaps).substr(0, 3) + " ref=" + to_string(refFraction).substr(0, 3)
+							+ " insert=" + to_string(params.inserted) + " seed=" + to_string(seed));
+				}
+			}
+		}
+		char dir[] = "/tmp/scoretest.XXXXXX";
+		if(mkdtemp(dir) == NULL) { throw CError("\nError: cannot make a temporary directory\n"); }
+		for(EFileType format : { FASTA, MSF, Phylip, Interleaved }) {
+			params.nSeq = 30;
+			params.gaps = 0.3;
+			params.refFraction = 0.5;
+			params.inserted = 20;
+			params.seed = 5;
+			FileCheck(params, format, dir);
+		}
+		GzipStdinCheck(params, dir);
+		ParallelReadCheck(params, dir);
+		ShardCheck(params, dir);
+		PairFileCheck(params, dir);
+		IncrementalCheck(params);
+		MetricsCheck(params);
+		SamplingCheck(params);
+		rmdir(dir);
+		AllocationCheck(params);
+	} catch(CError &e) {
+		cerr << e.what();
+		return -1;
+	}
+	cout << (failures ? to_string(failures) + " checks FAILED\n" : "All checks passed\n");
+	return failures ? -1 : 0;
+}